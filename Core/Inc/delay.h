@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    delay.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Calibrated busy-wait delays
+  *
+  *          Delays count core clock cycles with the DWT cycle counter so they
+  *          hold at any SystemCoreClock and optimisation level. The counter is
+  *          free running, the SysTick timer is left to the application.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __DELAY_H
+#define __DELAY_H
+
+#include "stm32f10x.h"
+
+
+
+
+/**
+ * @brief    Enable the DWT cycle counter used by the delays
+ *           Called by delay_us() when the counter is off, a debugger
+ *           may also have enabled it already.
+ * @param    none
+ * @retval   none
+ */
+void delay_init(void);
+
+
+/**
+ * @brief    Busy-wait for a number of microseconds
+ *           Uses SystemCoreClock, call SystemCoreClockUpdate() after changing
+ *           the clock tree. The wait is at least us, interrupts only extend it.
+ * @param    us: microseconds to wait, up to 59 s at 72 MHz
+ * @retval   none
+ */
+void delay_us(uint32_t us);
+
+
+/**
+ * @brief    Busy-wait for a number of milliseconds
+ * @param    ms: milliseconds to wait
+ * @retval   none
+ */
+void delay_ms(uint32_t ms);
+
+
+
+#endif /* __DELAY_H */
@@ -41,6 +41,23 @@
 /* Own address used when in SLAVE mode */
 #define USE_I2C_REMAP               0
 
+/* Transaction descriptors queued per I2C peripheral, power of 2 up to 128 */
+#define I2C_QUEUE_SIZE              8
+
+/* Queued payloads up to this size are copied into the descriptor */
+#define I2C_XFER_INLINE             8
+
+/* Queued payloads from this size on are sent with DMA, if enabled */
+#define I2C_DMA_MIN_BYTES           16
+
+/* Polls of i2c_busy(), i2c_claim() or i2c_enqueue() while the stop condition of
+   the previous transaction is still pending, the next queued transaction is
+   aborted after that many */
+#define I2C_STOP_RETRIES            1000
+
+/* Wait in i2c_init() for VDD and the bus lines to settle, in microseconds */
+#define I2C_POWERUP_DELAY_US        100
+
 
 
 
@@ -112,6 +129,10 @@ typedef enum
 } i2cMode_t;
 
 
+/* Completion callback of background transfers */
+typedef void (*i2cCallback_t)(void);
+
+
 
 
 
@@ -149,6 +170,30 @@ void i2c_stop(I2C_TypeDef* I2Cx);
 
 
 
+/**
+ * @brief    Claim the bus for a polled transaction, call before i2c_start()
+ *           The check and the claim are atomic, i2c_enqueue() from an
+ *           interrupt cannot start the queue in between. Transactions queued
+ *           meanwhile wait for i2c_release(). Issues a start condition
+ *           deferred by the transaction queue, see i2c_busy().
+ * @param    none
+ * @retval   1 if claimed, 0 if a background transfer is in progress
+ */
+uint8_t i2c_claim(I2C_TypeDef* I2Cx);
+
+
+
+/**
+ * @brief    Release the bus claimed with i2c_claim(), call after i2c_stop()
+ *           Starts the transactions queued meanwhile. Not needed after
+ *           i2c_write_dma(), it releases the bus itself.
+ * @param    none
+ * @retval   none
+ */
+void i2c_release(I2C_TypeDef* I2Cx);
+
+
+
 /**
  * @brief    This function is called after issuing a start condition,
  *           this initiates the communication to slave device.
@@ -170,12 +215,98 @@ void i2c_write(I2C_TypeDef* I2Cx, uint8_t data);
 
 /**
  * @brief    Transmit a N byte of data
+ *           Note: In MASTER mode the bytes are streamed back-to-back
+ *           within the current transaction, no START or address phase
+ *           is repeated between them.
  * @param    mode: MASTER or SLAVE transmitter
+ * @param    data_bytes: number of bytes to transmit, up to 65535
+ * @param    data_buffer: pointer to array where data are stored
+ * @retval   none
+ */
+void i2c_write_burst(I2C_TypeDef* I2Cx, i2cMode_t mode, uint16_t data_bytes, const uint8_t *data_buffer);
+
+
+
+/**
+ * @brief    Transmit a N byte of data in the background using DMA
+ *           This function is called after i2c_request() in MASTER mode
+ *           and returns as soon as the DMA channel is armed. The stop
+ *           condition is issued by the driver once the last byte left
+ *           the shift register, then callback is invoked from the I2Cx
+ *           event interrupt. If DMA was not enabled in i2c_init() the data is
+ *           sent with i2c_write_burst() and callback is invoked before
+ *           returning. Either way the bus claimed with i2c_claim() is
+ *           released once the transfer completes.
+ *           Note: data_buffer must stay valid until the transfer completes,
+ *                 poll i2c_busy() or wait for the callback.
  * @param    data_bytes: number of bytes to transmit
  * @param    data_buffer: pointer to array where data are stored
+ * @param    callback: function called on completion, can be 0
  * @retval   none
  */
-void i2c_write_burst(I2C_TypeDef* I2Cx, i2cMode_t mode, uint8_t data_bytes, uint8_t *data_buffer);
+void i2c_write_dma(I2C_TypeDef* I2Cx, uint16_t data_bytes, const uint8_t *data_buffer, i2cCallback_t callback);
+
+
+
+/**
+ * @brief    Check if a DMA transmission, queued transaction or claimed polled
+ *           transaction is still in progress
+ *           A queued transaction that follows a stop condition still being
+ *           sent waits for it outside interrupt context: this function,
+ *           i2c_claim() and i2c_enqueue() issue its start condition once the
+ *           stop went out. Poll one of them until the queue drains, from
+ *           the main loop or a periodic interrupt such as SysTick_Handler()
+ *           running below the I2C interrupt priority.
+ * @param    none
+ * @retval   1 if busy, 0 if the bus is free
+ */
+uint8_t i2c_busy(I2C_TypeDef* I2Cx);
+
+
+
+/**
+ * @brief    Check if the last DMA transmission or queued transaction failed
+ *           Valid inside its callback and once i2c_busy() returned 0.
+ * @param    none
+ * @retval   1 if it was aborted by a bus or DMA transfer error, 0 if it was sent
+ */
+uint8_t i2c_txError(I2C_TypeDef* I2Cx);
+
+
+
+/**
+ * @brief    Queue a complete write transaction
+ *           [S] [slave_addr_rw] [ctrl_byte] [data 0] .. [data N-1] [P]
+ *           The transaction is carried out by the I2Cx event/error interrupts
+ *           and this function returns immediately. Payloads of at least
+ *           I2C_DMA_MIN_BYTES are handed to DMA when it was enabled in i2c_init().
+ *           Note: Payloads up to I2C_XFER_INLINE bytes are copied into the
+ *                 descriptor, larger ones must stay valid until callback.
+ *                 The callback is invoked from interrupt context, also
+ *                 when the transaction was aborted by a bus error,
+ *                 i2c_txError() tells which. A transaction aborted because
+ *                 the previous stop condition never went out calls it from
+ *                 i2c_busy(), i2c_claim() or i2c_enqueue().
+ * @param    slave_addr_rw: pre-shifted slave address and pre-appended RnW bit
+ * @param    ctrl_byte: first byte sent after the address
+ * @param    data_bytes: number of bytes to transmit after ctrl_byte
+ * @param    data_buffer: pointer to array where data are stored
+ * @param    callback: function called on completion, can be 0
+ * @retval   1 if queued, 0 if all I2C_QUEUE_SIZE descriptors are in use
+ */
+uint8_t i2c_enqueue(I2C_TypeDef* I2Cx, uint8_t slave_addr_rw, uint8_t ctrl_byte,
+                    uint16_t data_bytes, const uint8_t *data_buffer, i2cCallback_t callback);
+
+
+
+/**
+ * @brief    Number of DMA transmissions and queued transactions aborted by
+ *           an error (NACK, bus error, arbitration lost, overrun, timeout
+ *           or DMA transfer error)
+ * @param    none
+ * @retval   error count since i2c_init()
+ */
+uint32_t i2c_queueErrors(I2C_TypeDef* I2Cx);
 
 
 
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_console.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Scrolling text console for the SSD1306
+  *
+  *          The 8 pages are used as a ring of 21 character text rows. A new line at
+  *          the bottom clears the oldest page and moves the display start line, so
+  *          scrolling costs one command instead of rewriting the screen.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_CONSOLE_H
+#define __SSD1306_CONSOLE_H
+
+#include "ssd1306_text.h"
+
+
+/* Characters per row with the 6 column cell of the 5x7 font */
+#define SSD1306_CONSOLE_COLS        ( SSD1306_WIDTH / 6 )
+#define SSD1306_CONSOLE_ROWS        8
+
+
+
+
+/**
+ * @brief    Clear the screen and start the console at the top row
+ *           Note: While the console is used the display start line is moved,
+ *                 other drawing functions work on GDDRAM pages, not screen rows.
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_consoleInit(void);
+
+
+/**
+ * @brief    Write characters to the console
+ *           '\n' starts a new row, '\r' returns to the start of the row and
+ *           rows wrap after SSD1306_CONSOLE_COLS characters. Only the rows
+ *           written to are flushed. In RENDER_DEFERRED they are left to the
+ *           caller's ssd1306_flush(), the display scrolls at once.
+ * @param    buf: pointer to characters
+ * @param    len: number of characters
+ * @retval   none
+ */
+void ssd1306_consoleWrite(const char *buf, uint16_t len);
+
+
+/**
+ * @brief    Write a null-terminated string to the console
+ * @param    str: pointer to null-terminated string
+ * @retval   none
+ */
+void ssd1306_consolePuts(const char *str);
+
+
+
+#endif /* __SSD1306_CONSOLE_H */
@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_field.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Numeric field widget for the SSD1306
+  *
+  *          A field formats integers and fixed-point values without printf and
+  *          remembers what it shows, so an update redraws only the character
+  *          cells that changed.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_FIELD_H
+#define __SSD1306_FIELD_H
+
+#include "ssd1306_text.h"
+
+
+/* Widest field in characters, sign and decimal point included */
+#define SSD1306_FIELD_MAX_CHARS     12
+
+
+typedef struct
+{
+    const SSD1306_Font_t *font;
+    int16_t x_pos;
+    int16_t y_pos;
+    uint8_t chars;                              /* field width in characters */
+    uint8_t decimals;                           /* digits after the decimal point */
+    char shown[SSD1306_FIELD_MAX_CHARS];        /* characters on the display, 0 if not drawn */
+} SSD1306_Field_t;
+
+
+
+
+/**
+ * @brief    Initializes a SSD1306_Field_t type structure
+ *           Values are right aligned in chars cells of pitch + spacing columns.
+ *           Nothing is drawn until the first ssd1306_fieldSet().
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    x_pos: x-coordinate of the field's upper left corner
+ * @param    y_pos: y-coordinate of the field's upper left corner
+ * @param    chars: field width in characters, up to SSD1306_FIELD_MAX_CHARS
+ * @param    decimals: digits after the decimal point, 0 for integers, up to 9
+ * @retval   none
+ */
+void ssd1306_fieldInit(SSD1306_Field_t *field, const SSD1306_Font_t *text_font,
+                       int16_t x_pos, int16_t y_pos, uint8_t chars, uint8_t decimals);
+
+
+/**
+ * @brief    Show a value in the field, only the cells whose character
+ *           changed are redrawn and marked dirty
+ *           The value is fixed-point: with 2 decimals 1234 shows as 12.34.
+ *           A value too wide for the field shows as all '#'.
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @param    value: value to show
+ * @retval   number of cells redrawn
+ */
+uint8_t ssd1306_fieldSet(SSD1306_Field_t *field, int32_t value);
+
+
+/**
+ * @brief    Forget what the field shows, the next ssd1306_fieldSet()
+ *           redraws every cell
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @retval   none
+ */
+void ssd1306_fieldInvalidate(SSD1306_Field_t *field);
+
+
+
+#endif /* __SSD1306_FIELD_H */
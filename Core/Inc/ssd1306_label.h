@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_label.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Cache of rendered text labels
+  *
+  *          Labels that are drawn over and over are rasterised once into a fixed
+  *          pool and blitted from there afterwards. Slots are reused least recently
+  *          used first.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_LABEL_H
+#define __SSD1306_LABEL_H
+
+#include "ssd1306_text.h"
+
+
+/* Number of cached labels and the bitmap bytes of each */
+#define SSD1306_LABEL_SLOTS         8
+#define SSD1306_LABEL_SLOT_SIZE     128
+
+/* Longest string a slot keeps to confirm a hit, terminator included */
+#define SSD1306_LABEL_TEXT_SIZE     24
+
+
+typedef enum
+{
+    LABEL_NORMAL = 0x00,
+    LABEL_INVERSE = 0x01,
+    LABEL_UNDERLINE = 0x02
+} SSD1306_LabelStyle_t;
+
+typedef struct
+{
+    uint32_t hits;              /* ssd1306_drawLabel() calls served from the label cache */
+    uint32_t misses;            /* ssd1306_drawLabel() calls that rasterised the string */
+    uint16_t bytes;             /* label cache bytes holding a bitmap */
+    uint16_t pool;              /* label cache size in bytes */
+} SSD1306_LabelStats_t;
+
+
+
+
+/**
+ * @brief    Draw a string through the label cache
+ *           The label is looked up by string, font and style. A hit is a
+ *           single ssd1306_blit(), a miss rasterises the string into the least
+ *           recently used slot first. Labels larger than a slot or longer than
+ *           SSD1306_LABEL_TEXT_SIZE - 1 characters are drawn with
+ *           ssd1306_drawText() and not cached.
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @param    x_pos: x-coordinate of the label's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the label's upper left corner, can be negative
+ * @param    style: LABEL_NORMAL, or LABEL_INVERSE and/or LABEL_UNDERLINE
+ * @retval   the on-screen area that was drawn, width 0 if fully clipped
+ */
+SSD1306_Rect_t ssd1306_drawLabel(const SSD1306_Font_t *text_font, const char *str,
+                                 int16_t x_pos, int16_t y_pos, uint8_t style);
+
+
+/**
+ * @brief    Drop every cached label, the hit counters are kept
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_labelFlush(void);
+
+
+/**
+ * @brief    Read the label cache statistics
+ * @param    stats: pointer to SSD1306_LabelStats_t type structure to fill
+ * @retval   none
+ */
+void ssd1306_labelGetStats(SSD1306_LabelStats_t *stats);
+
+
+
+#endif /* __SSD1306_LABEL_H */
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_log.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Interrupt-safe log sink for the SSD1306 console
+  *
+  *          Any number of writers, in the main loop and in interrupts, push
+  *          characters into one ring and return at once. A writer masks
+  *          interrupts (PRIMASK) only to reserve its space and again to
+  *          publish it, the copy runs with interrupts enabled. The main loop
+  *          drains the ring into the console, so no writer ever waits for the
+  *          I2C bus.
+  *
+  *          Reserved space becomes readable only when the last overlapping
+  *          writer finishes: the published head moves up once no write is in
+  *          progress. Writers that keep interrupting one another without a
+  *          gap can hold back all output until they stop.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_LOG_H
+#define __SSD1306_LOG_H
+
+#include "ssd1306_console.h"
+
+
+/* Ring size in characters, must be a power of two */
+#define SSD1306_LOG_SIZE            256
+
+
+
+
+/**
+ * @brief    Queue characters for the console, never blocks
+ *           Safe to call from the main loop and from interrupts of any
+ *           priority at the same time. Characters that do not fit are dropped.
+ * @param    buf: pointer to characters
+ * @param    len: number of characters
+ * @retval   number of characters queued
+ */
+uint16_t ssd1306_logWrite(const char *buf, uint16_t len);
+
+
+/**
+ * @brief    Move the queued characters to the console, call from the
+ *           main loop. Only the console rows written to are flushed.
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_logDrain(void);
+
+
+/**
+ * @brief    Number of characters dropped because the ring was full
+ * @param    none
+ * @retval   dropped characters since reset
+ */
+uint32_t ssd1306_logDropped(void);
+
+
+/**
+ * @brief    newlib system call behind printf() and puts(), stdout and
+ *           stderr go to ssd1306_logWrite()
+ *           Note: printf() itself is not reentrant, call ssd1306_logWrite()
+ *                 directly from interrupts.
+ * @param    file: file descriptor, 1 or 2
+ * @param    ptr: pointer to characters
+ * @param    len: number of characters
+ * @retval   len, or -1 for any other file
+ */
+int _write(int file, char *ptr, int len);
+
+
+
+#endif /* __SSD1306_LOG_H */
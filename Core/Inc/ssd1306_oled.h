@@ -45,6 +45,21 @@
  * 
  * CTRL_BYTE decides wether the following DATA will be a command or data which will be stored in GDDRAM
  * 
+ * Full frame (1024 GDDRAM bytes) bytes-on-wire, cursor move included:
+ * 
+ *   one transaction per byte : 8 + 1024 * 3 = 3080 bytes, 1025 START   ~70 ms @ 400 KHz
+ *   single burst transaction : 8 + 2 + 1024 = 1034 bytes,    2 START   ~24 ms @ 400 KHz
+ * 
+ * Window and data in one transaction (SSD1306_USE_CO_BIT), Co = 1 before each command byte:
+ * 
+ * [S] [ADDR_W] 0x80 0x21 0x80 c0 0x80 c1 0x80 0x22 0x80 p0 0x80 p1 [DATA_CTRL_BYTE] [DATA] .. [P]
+ * 
+ * Every call that goes on the bus (the display*, draw* and update functions, and
+ * ssd1306_flush() with the layers built on it) waits for a background transfer
+ * to end first. Never call them from an interrupt handler at or above the I2C
+ * event interrupt priority: that transfer cannot end there, the call is dropped
+ * after SSD1306_CLAIM_TIMEOUT_US and ssd1306_busDropped() reports it.
+ * 
 **/
 
 
@@ -52,6 +67,37 @@
 /* I2C peripheral used, either I2C1 or I2C2 */
 #define SSD1306_I2Cx                ( I2C1 )
 
+/* Set to 1 to draw into a second 1 KB buffer while ssd1306_present()
+   streams the previous frame in the background */
+#define SSD1306_DOUBLE_BUFFER       0
+
+/* Set to 1 to keep a 1 KB copy of what is on the display so
+   ssd1306_flush() can send only the bytes that changed */
+#define SSD1306_USE_SHADOW          0
+
+/* Set to 1 to keep a CRC signature of every 16 column block (256 bytes)
+   so ssd1306_flush() can send only the blocks that changed. Uses the CRC
+   calculation unit, define SSD1306_SW_CRC to compute it in software */
+#define SSD1306_USE_CRC             0
+
+/* Set to 1 to send a window setup and its GDDRAM data in one transaction,
+   every command byte preceded by a Co = 1 control byte (0x80) and the data
+   by 0x40. Saves a START, address and STOP per window at the cost of 4 more
+   bytes, a gain when transactions are slow to set up (polled waits, busy
+   bus) rather than bytes slow to send */
+#define SSD1306_USE_CO_BIT          0
+
+/* Bytes of commands ssd1306_cmdBegin() .. ssd1306_cmdEnd() can collect
+   before the batch is sent early */
+#define SSD1306_CMD_BATCH_SIZE      32
+
+/* Longest wait of a call that goes on the bus for a background transfer to end,
+   in microseconds, the call is dropped after that, see ssd1306_busDropped() */
+#define SSD1306_CLAIM_TIMEOUT_US    50000
+
+/* Wait in ssd1306_init() before the first command, in microseconds */
+#define SSD1306_POWERUP_DELAY_US    25
+
 /* SSD1306 Display Width and Height */
 #define SSD1306_WIDTH               128
 #define SSD1306_HEIGHT              64
@@ -129,6 +175,44 @@ typedef enum
 } SSD1306_AddrMode_t;
 
 
+/* Completion callback of background updates */
+typedef i2cCallback_t SSD1306_Callback_t;
+
+
+typedef enum
+{
+    FLUSH_DIRTY = 0,
+    FLUSH_SHADOW,
+    FLUSH_CRC
+} SSD1306_FlushMode_t;
+
+
+typedef enum
+{
+    ROP_COPY = 0,
+    ROP_OR,
+    ROP_AND,
+    ROP_XOR,
+    ROP_ANDNOT
+} SSD1306_Rop_t;
+
+
+typedef enum
+{
+    RENDER_IMMEDIATE = 0,
+    RENDER_DEFERRED
+} SSD1306_RenderMode_t;
+
+
+typedef struct
+{
+    uint32_t flushes;           /* calls to ssd1306_flush(), one per drawing call in RENDER_IMMEDIATE */
+    uint32_t last_bytes;        /* bytes on the wire of the last flush */
+    uint32_t last_saved;        /* bytes saved by the last flush compared to a full update */
+    uint32_t total_saved;       /* bytes saved by all flushes */
+} SSD1306_Stats_t;
+
+
 
 
 /**
@@ -139,6 +223,17 @@ typedef enum
 void ssd1306_init(void);
 
 
+/**
+ * @brief    Executes display's initialization sequence with a bitmap as the
+ *           first frame. The commands go in one transaction and the GDDRAM is
+ *           written while the display is still off, it is only turned on
+ *           once the frame is complete.
+ * @param    bitmap: pointer to a 1024 byte bitmap, 0 for a blank display
+ * @retval   none
+ */
+void ssd1306_initSplash(const uint8_t *bitmap);
+
+
 /**
  * @brief    Print character(s) to the current cursor position on display
  * @param    ch: pointer to array of character(s)
@@ -149,12 +244,44 @@ void ssd1306_drawChar(const char *ch);
 
 /**
  * @brief    Prints a bitmap to the entire display
+ *           The bitmap is copied into the GDDRAM, drawing continues on top of it.
  * @param    bitmap: pointer to bitmap
  * @retval   none
  */
 void ssd1306_drawBitmap(const uint8_t *bitmap);
 
 
+/**
+ * @brief    Copy a bitmap of any size to any position on the display
+ *           The bitmap is page-major like the GDDRAM: each byte is a column of
+ *           8 rows, the first width bytes hold rows 0..7, the next width bytes
+ *           rows 8..15 and so on. Parts outside the display are clipped.
+ * @param    src: pointer to bitmap, width * ((height + 7) / 8) bytes
+ * @param    width: bitmap width in pixels
+ * @param    height: bitmap height in pixels, rows past it in the last page are ignored
+ * @param    x_pos: x-coordinate of the bitmap's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the bitmap's upper left corner, can be negative
+ * @param    rop: how bitmap pixels combine with the display, any one of SSD1306_Rop_t
+ *                ROP_COPY, ROP_OR, ROP_AND, ROP_XOR, ROP_ANDNOT (clears the set pixels)
+ * @retval   none
+ */
+void ssd1306_blit(const uint8_t *src, uint8_t width, uint8_t height, int16_t x_pos, int16_t y_pos, SSD1306_Rop_t rop);
+
+
+/**
+ * @brief    Copy an area of the GDDRAM into a bitmap, the reverse of ssd1306_blit()
+ *           The bitmap is page-major with its row 0 at bit 0 of the first width
+ *           bytes. Pixels outside the display read as 0.
+ * @param    dst: pointer to bitmap, width * ((height + 7) / 8) bytes
+ * @param    width: area width in pixels
+ * @param    height: area height in pixels
+ * @param    x_pos: x-coordinate of the area's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the area's upper left corner, can be negative
+ * @retval   none
+ */
+void ssd1306_ramRead(uint8_t *dst, uint8_t width, uint8_t height, int16_t x_pos, int16_t y_pos);
+
+
 /**
  * @brief    Draw a pixel anywhere on the display
  * @param    x_pos: x-coordinate of pixel
@@ -204,6 +331,18 @@ void ssd1306_drawVerticalLine(uint8_t x_pos, uint8_t y_pos1, uint8_t y_pos2);
 void ssd1306_drawHorizontalLine(uint8_t y_pos, uint8_t x_pos1, uint8_t x_pos2);
 
 
+/**
+ * @brief    Fill or clear a rectangle anywhere on the display, clipped at the edges
+ * @param    x_pos: x-coordinate of the upper left corner
+ * @param    y_pos: y-coordinate of the upper left corner
+ * @param    width: rectangle width in pixels
+ * @param    height: rectangle height in pixels
+ * @param    state: TRUE to set the pixels, FALSE to clear them
+ * @retval   none
+ */
+void ssd1306_fillRect(uint8_t x_pos, uint8_t y_pos, uint8_t width, uint8_t height, SSD1306_FunctionalState_t state);
+
+
 /**
  * @brief    Draw a circle anywhere on the display
  * @param    x_cen: x-coordinate of circle's center, range 0..display width
@@ -224,7 +363,48 @@ void ssd1306_displayMoveCursor(uint8_t col, SSD1306_PageNum_t row);
 
 
 /**
- * @brief    Clears the entire display
+ * @brief    Set the column and page window of the GDDRAM address pointer,
+ *           the pointer moves to (col_start, page_start) and wraps inside the window
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, PAGE0..PAGE7
+ * @param    page_end: last page, PAGE0..PAGE7
+ * @retval   none
+ */
+void ssd1306_displaySetWindow(uint8_t col_start, uint8_t col_end, SSD1306_PageNum_t page_start, SSD1306_PageNum_t page_end);
+
+
+/**
+ * @brief    Write bytes straight to the display GDDRAM at the address pointer
+ *           in a single transaction, the framebuffer is left untouched
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @retval   none
+ */
+void ssd1306_displayWriteData(const uint8_t *data, uint16_t len);
+
+
+/**
+ * @brief    Write bytes to a GDDRAM window, the window setup and the data
+ *           share one transaction when SSD1306_USE_CO_BIT is set
+ *           Note: * The framebuffer is left untouched.
+ *                 * The window setup is skipped when the bytes land at the
+ *                   address pointer of a single page without wrapping, later
+ *                   writes must not rely on the window wrapping.
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, PAGE0..PAGE7
+ * @param    page_end: last page, PAGE0..PAGE7
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @retval   none
+ */
+void ssd1306_displayWriteWindow(uint8_t col_start, uint8_t col_end, SSD1306_PageNum_t page_start,
+                                SSD1306_PageNum_t page_end, const uint8_t *data, uint16_t len);
+
+
+/**
+ * @brief    Clears the entire display and the GDDRAM
  * @param    none
  * @retval   none
  */
@@ -239,6 +419,16 @@ void ssd1306_displayClear(void);
 void ssd1306_displayContrast(uint8_t val);
 
 
+/**
+ * @brief    Set the GDDRAM row shown on the top line of the display
+ *           The display wraps around, so this scrolls the whole screen
+ *           vertically without rewriting the GDDRAM.
+ * @param    line: row from 0..63, reset value is 0
+ * @retval   none
+ */
+void ssd1306_displayStartLine(uint8_t line);
+
+
 /**
  * @brief    Inverts the display
  *           If TRUE, applying '1' in any bit position turns off the pixel.
@@ -344,6 +534,42 @@ void ssd1306_displayAddrMode(SSD1306_AddrMode_t mode);
 void ssd1306_displayFlip(SSD1306_Orientation_t orientation, FunctionalState state);
 
 
+/**
+ * @brief    Send the initialization sequence again followed by every cached
+ *           setting that differs from it, in one command transaction, and
+ *           repaint the whole display on the next flush
+ *           Use after the panel lost its state, e.g. a reset or brown-out of
+ *           the display alone, or after ssd1306_busDropped() reported a
+ *           dropped call, which it clears. Charge pump, timing and panel layout are those
+ *           of ssd1306_init(), the rest as last set through the
+ *           ssd1306_display* functions.
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_resync(void);
+
+
+/**
+ * @brief    Start collecting commands, the ssd1306_display* functions add their
+ *           command bytes to a batch instead of sending each in a transaction
+ *           Calls can be nested, the batch goes out at the outermost
+ *           ssd1306_cmdEnd(). It is sent early when it fills up or before any
+ *           GDDRAM data so the order on the bus is kept.
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_cmdBegin(void);
+
+
+/**
+ * @brief    Send the commands collected since ssd1306_cmdBegin() after a
+ *           single [CMD_CTRL_BYTE] in one transaction
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_cmdEnd(void);
+
+
 /**
  * @brief    Update the entire GDDRAM
  * @param    none
@@ -352,6 +578,143 @@ void ssd1306_displayFlip(SSD1306_Orientation_t orientation, FunctionalState stat
 void ssd1306_ramUpdateFull(void);
 
 
+/**
+ * @brief    Select when the drawing functions reach the display
+ * @param    mode: RENDER_IMMEDIATE (default), every drawing function ends with
+ *                 ssd1306_flush() so the result shows at once, together with
+ *                 bytes left pending by ssd1306_ramWrite*().
+ *                 RENDER_DEFERRED, drawing functions only modify the GDDRAM,
+ *                 call ssd1306_flush() or ssd1306_present() to show the result.
+ * @retval   none
+ */
+void ssd1306_setRenderMode(SSD1306_RenderMode_t mode);
+
+
+/**
+ * @brief    Read the current render mode
+ * @param    none
+ * @retval   RENDER_IMMEDIATE or RENDER_DEFERRED
+ */
+SSD1306_RenderMode_t ssd1306_getRenderMode(void);
+
+
+/**
+ * @brief    Update the entire GDDRAM in the background
+ *           The cursor reset and the frame are queued as two transactions,
+ *           the frame is streamed with DMA when it was enabled in the
+ *           I2C_Init_t passed to i2c_init().
+ *           Note: Do not modify the GDDRAM until the transfer completes,
+ *                 polled display functions wait for it to complete.
+ * @param    callback: function called when the frame is on the display, can be 0
+ * @retval   none
+ */
+void ssd1306_flushAsync(SSD1306_Callback_t callback);
+
+
+/**
+ * @brief    Queue a command transaction, [CMD_CTRL_BYTE] [cmd 0] .. [cmd N-1]
+ *           Returns immediately unless all I2C_QUEUE_SIZE descriptors are in use,
+ *           then it waits for one to be freed.
+ *           Note: Lists longer than I2C_XFER_INLINE must stay valid until sent.
+ * @param    cmd: pointer to array of command bytes
+ * @param    len: number of command bytes
+ * @retval   none
+ */
+void ssd1306_queueCmd(const uint8_t *cmd, uint8_t len);
+
+
+/**
+ * @brief    Queue a GDDRAM data transaction, [DATA_CTRL_BYTE] [data 0] .. [data N-1]
+ *           Returns immediately unless all I2C_QUEUE_SIZE descriptors are in use,
+ *           then it waits for one to be freed.
+ *           Note: Data longer than I2C_XFER_INLINE must stay valid until callback.
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @param    callback: function called when the data was sent, can be 0
+ * @retval   none
+ */
+void ssd1306_queueData(const uint8_t *data, uint16_t len, SSD1306_Callback_t callback);
+
+
+/**
+ * @brief    Show the frame drawn in the GDDRAM
+ *           With SSD1306_DOUBLE_BUFFER the drawing buffer becomes the front
+ *           buffer and is streamed in the background, drawing continues in
+ *           the other buffer which starts as a copy of the presented frame.
+ *           Only waits if the previous frame is still being sent.
+ *           Without it this is the same as ssd1306_ramUpdateFull().
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_present(void);
+
+
+/**
+ * @brief    Check if a background update is still in progress
+ *           Polling it also moves the update on: a queued transaction that
+ *           waits for the previous stop condition is started from here, see
+ *           i2c_busy().
+ * @param    none
+ * @retval   1 if busy, 0 if idle
+ */
+uint8_t ssd1306_isBusy(void);
+
+
+/**
+ * @brief    Check if the last background update was aborted by a bus error,
+ *           the display then shows an incomplete frame
+ *           Valid inside its callback and once ssd1306_isBusy() returned 0.
+ * @param    none
+ * @retval   1 if it failed, 0 if it was sent
+ */
+uint8_t ssd1306_txError(void);
+
+
+/**
+ * @brief    Check if a display call was dropped because a background transfer
+ *           kept the bus for longer than SSD1306_CLAIM_TIMEOUT_US
+ *           The display then misses what that call sent, call ssd1306_resync()
+ *           and flush once ssd1306_isBusy() returned 0.
+ * @param    none
+ * @retval   1 if a call was dropped since the last ssd1306_resync(), 0 if not
+ */
+uint8_t ssd1306_busDropped(void);
+
+
+/**
+ * @brief    Update only the GDDRAM area that changed since the last update
+ *           FLUSH_DIRTY: each page that was written through the RAM-only functions
+ *           is sent as its own column window (0x21/0x22) followed by a burst of
+ *           the touched bytes.
+ *           FLUSH_SHADOW: each page is compared with the copy of the display and
+ *           only the changed runs of bytes are sent.
+ *           FLUSH_CRC: only the 16 column blocks whose signature changed are sent.
+ *           Note: The cursor window is left narrowed to the last run sent,
+ *                 call ssd1306_displayMoveCursor() before ssd1306_drawChar().
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_flush(void);
+
+
+/**
+ * @brief    Select how ssd1306_flush() finds the bytes to send
+ * @param    mode: FLUSH_DIRTY (default), FLUSH_SHADOW or FLUSH_CRC. FLUSH_SHADOW
+ *                 requires SSD1306_USE_SHADOW, FLUSH_CRC requires SSD1306_USE_CRC,
+ *                 they are ignored otherwise
+ * @retval   none
+ */
+void ssd1306_setFlushMode(SSD1306_FlushMode_t mode);
+
+
+/**
+ * @brief    Read the flush statistics
+ * @param    stats: pointer to SSD1306_Stats_t type structure to fill
+ * @retval   none
+ */
+void ssd1306_getStats(SSD1306_Stats_t *stats);
+
+
 /**
  * @brief    Update a byte of the GDDRAM
  * @param    byte_pos: address of the byte to update. value range 0..1023
@@ -370,12 +733,28 @@ void ssd1306_ramClear(void);
  *           Note: * The current value stored in the GDDRAM before a call to this
  *                   function will be retain.
  *                 * This will only write a value the GDDRAM, to display the
- *                   result ssd1306_ramUpdateFull() function must be called.
+ *                   result call ssd1306_flush() or ssd1306_ramUpdateFull().
+ *                   In RENDER_IMMEDIATE the next drawing call flushes it too.
  * @retval   none
  */
 void ssd1306_ramWrite(uint16_t byte_pos, uint8_t byte_val);
 
 
+/**
+ * @brief    Overwrite a run of bytes of one GDDRAM page
+ *           Copies a word at a time when the source and destination line up.
+ *           Note: This will only write the GDDRAM, call ssd1306_flush() to
+ *                 display the result. In RENDER_IMMEDIATE the next drawing
+ *                 call flushes it too.
+ * @param    page: page to write, PAGE0..PAGE7
+ * @param    col: first column, bytes past column 127 are dropped
+ * @param    data: pointer to the bytes to copy
+ * @param    len: number of bytes to copy
+ * @retval   none
+ */
+void ssd1306_ramWriteRun(SSD1306_PageNum_t page, uint8_t col, const uint8_t *data, uint8_t len);
+
+
 /**
  * @brief    Clears the entire GDDRAM
  * @param    none
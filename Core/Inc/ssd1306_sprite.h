@@ -0,0 +1,122 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_sprite.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Sprite layer on top of the SSD1306 framebuffer
+  *
+  *          Sprites are page-major bitmaps with an optional mask that are drawn
+  *          into the GDDRAM with ssd1306_blit() and can be moved without redrawing
+  *          the rest of the screen.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_SPRITE_H
+#define __SSD1306_SPRITE_H
+
+#include "ssd1306_oled.h"
+
+
+/* Tallest sprite supported, a sprite column must fit in a 32-bit word */
+#define SSD1306_SPRITE_MAX_HEIGHT   32
+
+
+typedef enum
+{
+    SPRITE_MASKED = 0,
+    SPRITE_XOR
+} SSD1306_SpriteMode_t;
+
+
+typedef struct
+{
+    const uint8_t *image;
+    const uint8_t *mask;
+    uint8_t *save_under;
+    uint8_t width;
+    uint8_t height;
+    int16_t x_pos;
+    int16_t y_pos;
+    SSD1306_SpriteMode_t mode;
+    uint8_t visible;
+} SSD1306_Sprite_t;
+
+
+
+
+/**
+ * @brief    Initializes a SSD1306_Sprite_t type structure
+ *           image, mask and save_under are page-major, width * ((height + 7) / 8) bytes.
+ *           SPRITE_MASKED: pixels set in mask are opaque and take the image
+ *           value, image must not set pixels outside the mask. The background under the sprite is kept in
+ *           save_under and put back when the sprite moves or is hidden.
+ *           SPRITE_XOR: image is XORed onto the display, drawing it twice restores
+ *           the background so save_under is not used and can be 0.
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @param    image: pointer to the sprite bitmap
+ * @param    mask: pointer to the sprite mask, 0 to use image as its own mask
+ * @param    save_under: pointer to the background buffer, 0 in SPRITE_XOR mode
+ * @param    width: sprite width in pixels
+ * @param    height: sprite height in pixels, up to SSD1306_SPRITE_MAX_HEIGHT
+ * @param    mode: SPRITE_MASKED or SPRITE_XOR
+ * @retval   none
+ */
+void ssd1306_spriteInit(SSD1306_Sprite_t *sprite, const uint8_t *image, const uint8_t *mask,
+                        uint8_t *save_under, uint8_t width, uint8_t height, SSD1306_SpriteMode_t mode);
+
+
+/**
+ * @brief    Draw the sprite at a position, a visible sprite is moved there
+ *           Only the old and the new sprite area are marked dirty.
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @param    x_pos: x-coordinate of the sprite's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the sprite's upper left corner, can be negative
+ * @retval   none
+ */
+void ssd1306_spriteMove(SSD1306_Sprite_t *sprite, int16_t x_pos, int16_t y_pos);
+
+
+/**
+ * @brief    Remove the sprite and restore the background under it
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @retval   none
+ */
+void ssd1306_spriteHide(SSD1306_Sprite_t *sprite);
+
+
+/**
+ * @brief    Pixel-perfect collision test between two sprites, the masks
+ *           are compared at the sprites' current positions
+ * @param    sprite_a: pointer to SSD1306_Sprite_t type structure
+ * @param    sprite_b: pointer to SSD1306_Sprite_t type structure
+ * @retval   1 if any opaque pixels overlap, 0 if not
+ */
+uint8_t ssd1306_spriteCollide(const SSD1306_Sprite_t *sprite_a, const SSD1306_Sprite_t *sprite_b);
+
+
+/**
+ * @brief    Pixel-perfect collision test between a sprite and the background
+ *           The sprite's own pixels are excluded when it is visible.
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @retval   1 if any opaque pixel covers a set background pixel, 0 if not
+ */
+uint8_t ssd1306_spriteCollideRam(const SSD1306_Sprite_t *sprite);
+
+
+
+#endif /* __SSD1306_SPRITE_H */
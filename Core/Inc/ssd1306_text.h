@@ -0,0 +1,127 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_text.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Text rendering into the SSD1306 framebuffer
+  *
+  *          Strings are drawn at any pixel position with fixed pitch or
+  *          proportional fonts. Glyphs are page-major bitmaps like ssd1306_blit()
+  *          takes, so rows that straddle two pages are shift-merged and clipped there.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_TEXT_H
+#define __SSD1306_TEXT_H
+
+#include "ssd1306_oled.h"
+
+
+/* Tallest glyph supported, same limit as a blit column pair of pages */
+#define SSD1306_FONT_MAX_HEIGHT     32
+
+
+typedef struct
+{
+    const uint8_t *glyphs;      /* page-major glyph bitmaps, one after another */
+    const uint16_t *offset;     /* start of each glyph in glyphs, 0 for fixed pitch */
+    const uint8_t *width;       /* width of each glyph in pixels, 0 for fixed pitch */
+    uint8_t pitch;              /* glyph width of a fixed pitch font */
+    uint8_t height;             /* glyph height in pixels, up to SSD1306_FONT_MAX_HEIGHT */
+    uint8_t first;              /* first character in the font */
+    uint8_t last;               /* last character in the font */
+    uint8_t spacing;            /* blank columns after each glyph */
+} SSD1306_Font_t;
+
+
+typedef struct
+{
+    int16_t x_pos;
+    int16_t y_pos;
+    uint8_t width;
+    uint8_t height;
+} SSD1306_Rect_t;
+
+
+typedef struct
+{
+    const uint8_t *bitmap;      /* page-major, width * ((height + 7) / 8) bytes */
+    uint8_t width;
+    uint8_t height;
+} SSD1306_Bitmap_t;
+
+
+/* The 5x7 font of ssd1306_font.h, fixed pitch and proportional */
+extern const SSD1306_Font_t ssd1306_font5x7;
+extern const SSD1306_Font_t ssd1306_font5x7p;
+
+
+
+
+/**
+ * @brief    Draw a string into the GDDRAM copy at any pixel position
+ *           Each glyph is followed by the font's spacing columns, which are
+ *           drawn as background with the same rop. Characters the font does not
+ *           have are drawn as its first character.
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @param    x_pos: x-coordinate of the text's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the text's upper left corner, can be negative
+ * @param    rop: how glyph pixels combine with the display, any one of SSD1306_Rop_t
+ * @retval   the on-screen area that was drawn, width 0 if fully clipped
+ */
+SSD1306_Rect_t ssd1306_drawText(const SSD1306_Font_t *text_font, const char *str,
+                                int16_t x_pos, int16_t y_pos, SSD1306_Rop_t rop);
+
+
+/**
+ * @brief    Width of a string in pixels, spacing columns included
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @retval   string width in pixels
+ */
+uint16_t ssd1306_textWidth(const SSD1306_Font_t *text_font, const char *str);
+
+
+/**
+ * @brief    Draw a string of the 5x7 font into one GDDRAM page
+ *           Fast path for page-aligned text: glyph columns are expanded into
+ *           a single run that is copied into the page with word copies. Text
+ *           past column 127 is dropped.
+ * @param    page: page to draw on, PAGE0..PAGE7
+ * @param    col: x-coordinate of the first column
+ * @param    str: pointer to null-terminated string
+ * @retval   number of columns drawn
+ */
+uint8_t ssd1306_drawTextLine(SSD1306_PageNum_t page, uint8_t col, const char *str);
+
+
+/**
+ * @brief    Send a string of the 5x7 font straight to one display page
+ *           The expanded run goes out as a single windowed burst.
+ *           Note: The framebuffer is not updated.
+ * @param    page: page to draw on, PAGE0..PAGE7
+ * @param    col: x-coordinate of the first column
+ * @param    str: pointer to null-terminated string
+ * @retval   number of columns sent
+ */
+uint8_t ssd1306_sendTextLine(SSD1306_PageNum_t page, uint8_t col, const char *str);
+
+
+
+#endif /* __SSD1306_TEXT_H */
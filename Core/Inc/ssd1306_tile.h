@@ -0,0 +1,84 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_tile.h
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Tile-map renderer for the SSD1306
+  *
+  *          The screen is a grid of 16x8 cells of 8x8 pixels. An 8x8 tile is
+  *          exactly 8 GDDRAM bytes of one page, so tiles are sent straight from a
+  *          flash-resident tile set and no framebuffer is needed.
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#ifndef __SSD1306_TILE_H
+#define __SSD1306_TILE_H
+
+#include "ssd1306_oled.h"
+
+
+/* Tile grid size, one tile per 8 columns of a page */
+#define SSD1306_TILE_COLS           ( SSD1306_WIDTH / 8 )
+#define SSD1306_TILE_ROWS           ( SSD1306_HEIGHT / 8 )
+
+
+
+
+/**
+ * @brief    Select the tile set and fill the map with tile 0
+ *           Every cell is marked changed so the next ssd1306_tileFlush()
+ *           redraws the whole screen.
+ * @param    tileset: pointer to array of 8 byte page-major tiles
+ * @retval   none
+ */
+void ssd1306_tileInit(const uint8_t (*tileset)[8]);
+
+
+/**
+ * @brief    Place a tile in a cell of the map, the cell is only marked
+ *           changed if its tile index differs
+ * @param    col: cell column, 0..15
+ * @param    row: cell row, PAGE0..PAGE7
+ * @param    tile: index into the tile set
+ * @retval   none
+ */
+void ssd1306_tileSet(uint8_t col, SSD1306_PageNum_t row, uint8_t tile);
+
+
+/**
+ * @brief    Read the tile index of a cell
+ * @param    col: cell column, 0..15, larger values read column 15
+ * @param    row: cell row, PAGE0..PAGE7, larger values read PAGE7
+ * @retval   index into the tile set
+ */
+uint8_t ssd1306_tileGet(uint8_t col, SSD1306_PageNum_t row);
+
+
+/**
+ * @brief    Send the changed cells to the display
+ *           Neighbouring changed cells of a row are sent as one window.
+ *           Note: Tiles are written straight to the display, the framebuffer
+ *                 is not updated. Does nothing before ssd1306_tileInit().
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_tileFlush(void);
+
+
+
+#endif /* __SSD1306_TILE_H */
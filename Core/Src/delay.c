@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file    delay.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Calibrated busy-wait delays
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "delay.h"
+
+
+/* DWT cycle counter, not covered by this version of core_cm3.h */
+#define DWT_CTRL                    ( *(volatile uint32_t *)0xE0001000UL )
+#define DWT_CYCCNT                  ( *(volatile uint32_t *)0xE0001004UL )
+#define DWT_CTRL_CYCCNTENA          ( 1UL << 0 )
+
+
+
+/**
+ * @brief    Enable the DWT cycle counter used by the delays
+ *           Called by delay_us() when the counter is off, a debugger
+ *           may also have enabled it already.
+ * @param    none
+ * @retval   none
+ */
+void delay_init(void)
+{
+    /* The DWT registers are only accessible with trace enabled */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+
+/**
+ * @brief    Busy-wait for a number of microseconds
+ *           Uses SystemCoreClock, call SystemCoreClockUpdate() after changing
+ *           the clock tree. The wait is at least us, interrupts only extend it.
+ * @param    us: microseconds to wait, up to 59 s at 72 MHz
+ * @retval   none
+ */
+void delay_us(uint32_t us)
+{
+    if( !(DWT_CTRL & DWT_CTRL_CYCCNTENA) )
+    {
+        delay_init();
+    }
+
+    uint32_t start = DWT_CYCCNT;
+    uint32_t cycles = us * (SystemCoreClock / 1000000UL);
+
+    /* Unsigned difference stays right across a counter wrap */
+    while( (DWT_CYCCNT - start) < cycles );
+}
+
+
+/**
+ * @brief    Busy-wait for a number of milliseconds
+ * @param    ms: milliseconds to wait
+ * @retval   none
+ */
+void delay_ms(uint32_t ms)
+{
+    while( ms-- )
+    {
+        delay_us(1000);
+    }
+}
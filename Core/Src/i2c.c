@@ -35,6 +35,11 @@
 
 #include "stm32f10x.h"
 #include "i2c.h"
+#include "delay.h"
+
+/* Registers are only reached through the I2Cx argument and the peripheral
+   pointers of i2c_tx_state, the host tests build this file against
+   Tests/host/stm32f10x.h instead of the device header */
 
 
 
@@ -46,8 +51,61 @@ typedef enum
 } i2cAckBit_t;
 
 
+/* Queued transaction descriptor */
+typedef struct
+{
+    uint8_t slave_addr_rw;
+    uint8_t ctrl_byte;
+    uint16_t data_bytes;
+    const uint8_t *data_buffer;
+    i2cCallback_t callback;
+    uint8_t inline_data[I2C_XFER_INLINE];
+} i2cXfer_t;
+
+
+/* Transaction queue and DMA bookkeeping, one entry per I2C peripheral */
+typedef struct
+{
+    I2C_TypeDef* i2c;
+    DMA_TypeDef* dma;
+    DMA_Channel_TypeDef* channel;
+    IRQn_Type dma_irq;
+    IRQn_Type ev_irq;
+    IRQn_Type er_irq;
+    uint8_t flag_shift;
+    uint8_t dma_enabled;
+    volatile uint8_t busy;
+    volatile uint8_t error;
+    uint8_t dma_direct;
+    uint16_t start_wait;
+    i2cCallback_t callback;
+
+    i2cXfer_t queue[I2C_QUEUE_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    uint16_t index;
+    uint8_t use_dma;
+    volatile uint32_t errors;
+} i2cTxState_t;
+
+/* I2C1_TX is served by DMA1 channel 6, I2C2_TX by DMA1 channel 4 */
+static i2cTxState_t i2c_tx_state[2] = { { .i2c = I2C1, .dma = DMA1, .channel = DMA1_Channel6,
+                                          .dma_irq = DMA1_Channel6_IRQn, .ev_irq = I2C1_EV_IRQn,
+                                          .er_irq = I2C1_ER_IRQn, .flag_shift = 20U },
+                                        { .i2c = I2C2, .dma = DMA1, .channel = DMA1_Channel4,
+                                          .dma_irq = DMA1_Channel4_IRQn, .ev_irq = I2C2_EV_IRQn,
+                                          .er_irq = I2C2_ER_IRQn, .flag_shift = 12U } };
+
+
 /* Static function prototype */
 static void i2c_ack_bit(I2C_TypeDef* I2Cx, i2cAckBit_t ack_nack);
+static i2cTxState_t* i2c_tx_lookup(I2C_TypeDef* I2Cx);
+static void i2c_dma_error(I2C_TypeDef* I2Cx);
+static void i2c_queue_start(I2C_TypeDef* I2Cx, i2cTxState_t *tx);
+static void i2c_start_deferred(I2C_TypeDef* I2Cx, i2cTxState_t *tx);
+static void i2c_transfer_done(I2C_TypeDef* I2Cx, i2cTxState_t *tx, uint8_t error);
+static void i2c_event_handler(I2C_TypeDef* I2Cx);
+static void i2c_error_handler(I2C_TypeDef* I2Cx);
 
 
 
@@ -95,53 +153,61 @@ void i2c_structInit(I2C_Init_t* i2c_conf)
 void i2c_init(I2C_TypeDef* I2Cx, I2C_Init_t* i2c_conf)
 {
     /* Small delay to ensures stable VDD */
-    for(uint16_t i = 0; i < 1000; i++);
-
-    uint32_t i2c_base = (uint32_t)I2Cx;
+    delay_us(I2C_POWERUP_DELAY_US);
 
     RCC->APB2ENR |= ( RCC_APB2ENR_AFIOEN | RCC_APB2ENR_IOPBEN );
 
-    switch(i2c_base)
+    if( I2Cx == I2C1 )
     {
-        case I2C1_BASE:
+        RCC->APB1ENR |= RCC_APB1ENR_I2C1EN;
 
-            RCC->APB1ENR |= RCC_APB1ENR_I2C1EN;
-
-            #if (!USE_I2C_REMAP)
-            
-            GPIOB->CRL |= (GPIO_CRL_CNF6 | GPIO_CRL_MODE6);
-            GPIOB->CRL |= (GPIO_CRL_CNF7 | GPIO_CRL_MODE7);
-            GPIOB->BSRR |= (GPIO_BSRR_BS6 | GPIO_BSRR_BS7);
+        #if (!USE_I2C_REMAP)
 
-            #else
+        GPIOB->CRL |= (GPIO_CRL_CNF6 | GPIO_CRL_MODE6);
+        GPIOB->CRL |= (GPIO_CRL_CNF7 | GPIO_CRL_MODE7);
+        GPIOB->BSRR |= (GPIO_BSRR_BS6 | GPIO_BSRR_BS7);
 
-            GPIOB->CRH |= (GPIO_CRH_CNF8 | GPIO_CRH_MODE8);
-            GPIOB->CRH |= (GPIO_CRH_CNF9 | GPIO_CRH_MODE9);
-            GPIOB->BSRR |= (GPIO_BSRR_BS8 | GPIO_BSRR_BS9);
+        #else
 
-            #endif
+        GPIOB->CRH |= (GPIO_CRH_CNF8 | GPIO_CRH_MODE8);
+        GPIOB->CRH |= (GPIO_CRH_CNF9 | GPIO_CRH_MODE9);
+        GPIOB->BSRR |= (GPIO_BSRR_BS8 | GPIO_BSRR_BS9);
 
-            break;
-
-        case I2C2_BASE:
+        #endif
+    }
+    else if( I2Cx == I2C2 )
+    {
+        RCC->APB1ENR |= RCC_APB1ENR_I2C2EN;
 
-            RCC->APB1ENR |= RCC_APB1ENR_I2C2EN;
+        GPIOB->CRH |= (GPIO_CRH_CNF10 | GPIO_CRH_MODE10);
+        GPIOB->CRH |= (GPIO_CRH_CNF11 | GPIO_CRH_MODE11);
+        GPIOB->BSRR |= (GPIO_BSRR_BS10 | GPIO_BSRR_BS11);
+    }
+    else
+    {
+        /* If you reached here you your I2Cx address is wrong */
+    }
 
-            GPIOB->CRH |= (GPIO_CRH_CNF10 | GPIO_CRH_MODE10);
-            GPIOB->CRH |= (GPIO_CRH_CNF11 | GPIO_CRH_MODE11);
-            GPIOB->BSRR |= (GPIO_BSRR_BS10 | GPIO_BSRR_BS11);
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
 
-            break;
+    /* Event and error interrupts drive the transaction queue, they
+       stay masked in CR2 while the queue is empty */
+    NVIC_EnableIRQ(tx->ev_irq);
+    NVIC_EnableIRQ(tx->er_irq);
 
-        default:
-            /* If you reached here you your I2Cx address is wrong */
-            break;
+    /* DMA1 clock and TX channel interrupt, the channel itself is
+       only armed by i2c_write_dma() or the transaction queue */
+    if( i2c_conf->I2C_DMA_TRANSFER )
+    {
+        RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+        NVIC_EnableIRQ(tx->dma_irq);
+        tx->dma_enabled = 1;
     }
 
 
     /* Perform a I2C peripheral reset */
     I2Cx->CR1 |= I2C_CR1_SWRST;
-    for(uint8_t i = 0; i < 100; i++);
+    delay_us(1);
     I2Cx->CR1 &= ~( I2C_CR1_SWRST );
 
     /* Set CR1 values */
@@ -253,6 +319,67 @@ void i2c_stop(I2C_TypeDef* I2Cx)
 
 
 
+/**
+ * @brief    Claim the bus for a polled transaction, call before i2c_start()
+ *           The check and the claim are atomic, i2c_enqueue() from an
+ *           interrupt cannot start the queue in between. Transactions queued
+ *           meanwhile wait for i2c_release(). Issues a start condition
+ *           deferred by the transaction queue, see i2c_busy().
+ * @param    none
+ * @retval   1 if claimed, 0 if a background transfer is in progress
+ */
+uint8_t i2c_claim(I2C_TypeDef* I2Cx)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+    uint8_t claimed = 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    i2c_start_deferred(I2Cx, tx);
+
+    if( !tx->busy )
+    {
+        tx->busy = 1;
+        claimed = 1;
+    }
+
+    __set_PRIMASK(primask);
+
+    return claimed;
+}
+
+
+
+/**
+ * @brief    Release the bus claimed with i2c_claim(), call after i2c_stop()
+ *           Starts the transactions queued meanwhile. Not needed after
+ *           i2c_write_dma(), it releases the bus itself.
+ * @param    none
+ * @retval   none
+ */
+void i2c_release(I2C_TypeDef* I2Cx)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* Transactions queued meanwhile waited for the bus */
+    if( tx->head != tx->tail )
+    {
+        i2c_queue_start(I2Cx, tx);
+    }
+    else
+    {
+        tx->busy = 0;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+
+
 /**
  * @brief    Issue a ACK or NACK. This function is not usually
  *           called explicitly, most of the time this is
@@ -313,19 +440,22 @@ void i2c_write(I2C_TypeDef* I2Cx, uint8_t data)
 
 /**
  * @brief    Transmit a N byte of data
+ *           Note: In MASTER mode the bytes are streamed back-to-back
+ *           within the current transaction, no START or address phase
+ *           is repeated between them.
  * @param    mode: MASTER or SLAVE transmitter
- * @param    data_bytes: number of bytes to transmit
+ * @param    data_bytes: number of bytes to transmit, up to 65535
  * @param    data_buffer: pointer to array where data are stored
  * @retval   none
  */
-void i2c_write_burst(I2C_TypeDef* I2Cx, i2cMode_t mode, uint8_t data_bytes, uint8_t *data_buffer)
+void i2c_write_burst(I2C_TypeDef* I2Cx, i2cMode_t mode, uint16_t data_bytes, const uint8_t *data_buffer)
 {
     if( mode )
     {
         /* EV6 - address matched, ADDR = 1. Clear ADDR bit */
         I2Cx->SR2 = I2Cx->SR2;
         /* EV8_1 - Loop through the buffer to transmit data */
-        for(uint8_t i = 0; i != data_bytes; i++)
+        for(uint16_t i = 0; i != data_bytes; i++)
         {
             while ( !(I2Cx->SR1 & I2C_SR1_TXE) );   
             I2Cx->DR = *(data_buffer + i);
@@ -342,7 +472,7 @@ void i2c_write_burst(I2C_TypeDef* I2Cx, i2cMode_t mode, uint8_t data_bytes, uint
         while( !((I2Cx->SR1 & I2C_SR1_ADDR)) );
         I2Cx->SR2 = I2Cx->SR2;
 
-        uint8_t j = 0;
+        uint16_t j = 0;
         /* EV3-1 - Loop through the buffer to transmit
            data until NACK is received */
         while( !(I2Cx->SR1 & I2C_SR1_AF) )
@@ -359,13 +489,205 @@ void i2c_write_burst(I2C_TypeDef* I2Cx, i2cMode_t mode, uint8_t data_bytes, uint
             /* Wait for ACK from master after each byte */
             while ( !(I2Cx->SR1 & I2C_SR1_TXE) );
         }
-        /* EV3-2 - NACK received, AF = 1, clear AF bit */
-        I2Cx->SR1 &= ~( I2C_SR1_AF );
+        /* EV3-2 - NACK received, AF = 1, clear AF bit. SR1 flags are cleared
+           by writing 0 and kept by writing 1, a read-modify-write could clear
+           a flag set in between */
+        I2Cx->SR1 = (uint16_t)~( I2C_SR1_AF );
     }
 }
 
 
 
+/**
+ * @brief    Transmit a N byte of data in the background using DMA
+ *           This function is called after i2c_request() in MASTER mode
+ *           and returns as soon as the DMA channel is armed. The stop
+ *           condition is issued by the driver once the last byte left
+ *           the shift register, then callback is invoked from the I2Cx
+ *           event interrupt. If DMA was not enabled in i2c_init() the data is
+ *           sent with i2c_write_burst() and callback is invoked before
+ *           returning. Either way the bus claimed with i2c_claim() is
+ *           released once the transfer completes.
+ *           Note: data_buffer must stay valid until the transfer completes,
+ *                 poll i2c_busy() or wait for the callback.
+ * @param    data_bytes: number of bytes to transmit
+ * @param    data_buffer: pointer to array where data are stored
+ * @param    callback: function called on completion, can be 0
+ * @retval   none
+ */
+void i2c_write_dma(I2C_TypeDef* I2Cx, uint16_t data_bytes, const uint8_t *data_buffer, i2cCallback_t callback)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+
+    if( !tx->dma_enabled || (data_bytes == 0) )
+    {
+        i2c_write_burst(I2Cx, MASTER, data_bytes, data_buffer);
+        i2c_stop(I2Cx);
+
+        tx->error = 0;
+        if(callback)
+        {
+            callback();
+        }
+        i2c_release(I2Cx);
+        return;
+    }
+
+    tx->busy = 1;
+    tx->dma_direct = 1;
+    tx->callback = callback;
+
+    /* Memory to peripheral, memory increment, 8-bit on both sides.
+       CCR bit layout is the same on every channel */
+    tx->channel->CCR = 0;
+    tx->channel->CPAR = (uint32_t)(uintptr_t)&I2Cx->DR;
+    tx->channel->CMAR = (uint32_t)(uintptr_t)data_buffer;
+    tx->channel->CNDTR = data_bytes;
+    tx->channel->CCR = ( DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_TEIE );
+
+    /* Route TXE to the DMA request line */
+    I2Cx->CR2 |= I2C_CR2_DMAEN;
+    /* EV6 - address matched, ADDR = 1. Clear ADDR bit */
+    I2Cx->SR2 = I2Cx->SR2;
+
+    /* The event interrupt ends the transfer on BTF after the last byte,
+       the error interrupt on a NACK or bus error */
+    I2Cx->CR2 |= ( I2C_CR2_ITEVTEN | I2C_CR2_ITERREN );
+
+    tx->channel->CCR |= DMA_CCR1_EN;
+}
+
+
+
+/**
+ * @brief    Check if a DMA transmission, queued transaction or claimed polled
+ *           transaction is still in progress
+ *           A queued transaction that follows a stop condition still being
+ *           sent waits for it outside interrupt context: this function,
+ *           i2c_claim() and i2c_enqueue() issue its start condition once the
+ *           stop went out. Poll one of them until the queue drains, from
+ *           the main loop or a periodic interrupt such as SysTick_Handler()
+ *           running below the I2C interrupt priority.
+ * @param    none
+ * @retval   1 if busy, 0 if the bus is free
+ */
+uint8_t i2c_busy(I2C_TypeDef* I2Cx)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    i2c_start_deferred(I2Cx, tx);
+
+    __set_PRIMASK(primask);
+
+    return tx->busy;
+}
+
+
+
+/**
+ * @brief    Check if the last DMA transmission or queued transaction failed
+ *           Valid inside its callback and once i2c_busy() returned 0.
+ * @param    none
+ * @retval   1 if it was aborted by a bus or DMA transfer error, 0 if it was sent
+ */
+uint8_t i2c_txError(I2C_TypeDef* I2Cx)
+{
+    return i2c_tx_lookup(I2Cx)->error;
+}
+
+
+
+/**
+ * @brief    Queue a complete write transaction
+ *           [S] [slave_addr_rw] [ctrl_byte] [data 0] .. [data N-1] [P]
+ *           The transaction is carried out by the I2Cx event/error interrupts
+ *           and this function returns immediately. Payloads of at least
+ *           I2C_DMA_MIN_BYTES are handed to DMA when it was enabled in i2c_init().
+ *           Note: Payloads up to I2C_XFER_INLINE bytes are copied into the
+ *                 descriptor, larger ones must stay valid until callback.
+ *                 The callback is invoked from interrupt context, also
+ *                 when the transaction was aborted by a bus error,
+ *                 i2c_txError() tells which. A transaction aborted because
+ *                 the previous stop condition never went out calls it from
+ *                 i2c_busy(), i2c_claim() or i2c_enqueue().
+ * @param    slave_addr_rw: pre-shifted slave address and pre-appended RnW bit
+ * @param    ctrl_byte: first byte sent after the address
+ * @param    data_bytes: number of bytes to transmit after ctrl_byte
+ * @param    data_buffer: pointer to array where data are stored
+ * @param    callback: function called on completion, can be 0
+ * @retval   1 if queued, 0 if all I2C_QUEUE_SIZE descriptors are in use
+ */
+uint8_t i2c_enqueue(I2C_TypeDef* I2Cx, uint8_t slave_addr_rw, uint8_t ctrl_byte,
+                    uint16_t data_bytes, const uint8_t *data_buffer, i2cCallback_t callback)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+
+    if( (uint8_t)(tx->tail - tx->head) == I2C_QUEUE_SIZE )
+    {
+        /* A deferred start may be all that holds the queue up */
+        i2c_busy(I2Cx);
+        return 0;
+    }
+
+    i2cXfer_t *xfer = &tx->queue[tx->tail % I2C_QUEUE_SIZE];
+
+    xfer->slave_addr_rw = slave_addr_rw;
+    xfer->ctrl_byte = ctrl_byte;
+    xfer->data_bytes = data_bytes;
+    xfer->callback = callback;
+
+    if( data_bytes <= I2C_XFER_INLINE )
+    {
+        for(uint8_t i = 0; i < data_bytes; i++)
+        {
+            xfer->inline_data[i] = data_buffer[i];
+        }
+        xfer->data_buffer = xfer->inline_data;
+    }
+    else
+    {
+        xfer->data_buffer = data_buffer;
+    }
+
+    /* The interrupt may be retiring the last descriptor right now,
+       publish the new one and test for idle without it interfering */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    tx->tail++;
+    if( !tx->busy )
+    {
+        i2c_queue_start(I2Cx, tx);
+    }
+    else
+    {
+        i2c_start_deferred(I2Cx, tx);
+    }
+
+    __set_PRIMASK(primask);
+
+    return 1;
+}
+
+
+
+/**
+ * @brief    Number of DMA transmissions and queued transactions aborted by
+ *           an error (NACK, bus error, arbitration lost, overrun, timeout
+ *           or DMA transfer error)
+ * @param    none
+ * @retval   error count since i2c_init()
+ */
+uint32_t i2c_queueErrors(I2C_TypeDef* I2Cx)
+{
+    return i2c_tx_lookup(I2Cx)->errors;
+}
+
+
+
 /**
  * @brief    Receives a byte of data
  *           Note: Stop condition is not required to call explicitly
@@ -514,7 +836,7 @@ static void i2c_config(void)
 {
     /* Perform a I2C peripheral reset */
     I2Cx->CR1 |= I2C_CR1_SWRST;
-    for(uint8_t i = 0; i < 100; i++);
+    delay_us(1);
     I2Cx->CR1 &= ~( I2C_CR1_SWRST );
 
     /* Set this mcu's slave address */
@@ -559,4 +881,299 @@ static void i2c_gpio(void)
 
     GPIOB->BSRR |= ( GPIO_BSRR_BS6 | GPIO_BSRR_BS7 );
 }
-#endif
\ No newline at end of file
+#endif
+
+
+
+/**
+ * @brief    Returns the DMA bookkeeping entry of I2Cx
+ * @param    none
+ * @retval   pointer to the entry
+ */
+static i2cTxState_t* i2c_tx_lookup(I2C_TypeDef* I2Cx)
+{
+    return (i2c_tx_state[0].i2c == I2Cx) ? &i2c_tx_state[0] : &i2c_tx_state[1];
+}
+
+
+
+/**
+ * @brief    Abort a DMA transmission on a transfer error, called from the
+ *           channel interrupt. Completion is signalled by the I2Cx event
+ *           interrupt, BTF after the last byte.
+ * @param    none
+ * @retval   none
+ */
+static void i2c_dma_error(I2C_TypeDef* I2Cx)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+
+    tx->dma->IFCR = (DMA_IFCR_CGIF1 << tx->flag_shift);
+
+    i2c_stop(I2Cx);
+    i2c_transfer_done(I2Cx, tx, 1);
+}
+
+
+
+/**
+ * @brief    Issue the start condition of the transaction at the queue head
+ *           and let the event interrupt take over, deferred to
+ *           i2c_start_deferred() while a stop condition is pending
+ * @param    none
+ * @retval   none
+ */
+static void i2c_queue_start(I2C_TypeDef* I2Cx, i2cTxState_t *tx)
+{
+    tx->busy = 1;
+
+    if( I2Cx->CR1 & I2C_CR1_STOP )
+    {
+        /* A stop condition requested just before is still pending, CR1 must
+           not be written until it is sent. No event follows a stop in master
+           mode, the next i2c_busy(), i2c_claim() or i2c_enqueue() checks
+           again instead of spinning here in interrupt context */
+        I2Cx->CR2 &= ~( I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN );
+        tx->start_wait = 1;
+        return;
+    }
+
+    I2Cx->CR2 |= ( I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN );
+    i2c_start(I2Cx);
+}
+
+
+
+/**
+ * @brief    Issue the start condition i2c_queue_start() deferred once the
+ *           pending stop condition went out, called with interrupts masked
+ *           After I2C_STOP_RETRIES calls the transaction is aborted as a bus
+ *           error, its callback runs from the caller's context.
+ * @param    none
+ * @retval   none
+ */
+static void i2c_start_deferred(I2C_TypeDef* I2Cx, i2cTxState_t *tx)
+{
+    if( !tx->start_wait )
+    {
+        return;
+    }
+
+    if( !(I2Cx->CR1 & I2C_CR1_STOP) )
+    {
+        tx->start_wait = 0;
+        I2Cx->CR2 |= ( I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN );
+        i2c_start(I2Cx);
+    }
+    else if( tx->start_wait++ > I2C_STOP_RETRIES )
+    {
+        /* The stop condition never went out, the bus is stuck */
+        tx->start_wait = 0;
+        i2c_transfer_done(I2Cx, tx, 1);
+    }
+}
+
+
+
+/**
+ * @brief    Retire the i2c_write_dma() transmission or the transaction at the
+ *           queue head and start the next one
+ *           Note: The stop condition is issued by the caller.
+ * @param    error: 1 if the transfer was aborted, 0 if it was sent
+ * @retval   none
+ */
+static void i2c_transfer_done(I2C_TypeDef* I2Cx, i2cTxState_t *tx, uint8_t error)
+{
+    i2cCallback_t callback;
+
+    if( tx->dma_direct )
+    {
+        callback = tx->callback;
+        tx->dma_direct = 0;
+    }
+    else
+    {
+        callback = tx->queue[tx->head % I2C_QUEUE_SIZE].callback;
+        tx->head++;
+    }
+
+    if( tx->dma_enabled )
+    {
+        tx->channel->CCR &= ~( DMA_CCR1_EN );
+        I2Cx->CR2 &= ~( I2C_CR2_DMAEN );
+        tx->use_dma = 0;
+    }
+
+    /* Read back by i2c_txError() from the callback */
+    tx->error = error;
+    if( error )
+    {
+        tx->errors++;
+    }
+
+    if(callback)
+    {
+        callback();
+    }
+
+    if( tx->head != tx->tail )
+    {
+        i2c_queue_start(I2Cx, tx);
+    }
+    else
+    {
+        I2Cx->CR2 &= ~( I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN );
+        tx->busy = 0;
+    }
+}
+
+
+
+/**
+ * @brief    Master transmitter state machine of the transaction queue,
+ *           follows the same EVx sequence as the polled functions
+ * @param    none
+ * @retval   none
+ */
+static void i2c_event_handler(I2C_TypeDef* I2Cx)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+    i2cXfer_t *xfer = &tx->queue[tx->head % I2C_QUEUE_SIZE];
+    uint16_t sr1 = I2Cx->SR1;
+
+    if( tx->dma_direct )
+    {
+        /* EV8_2 - i2c_write_dma() wrote the last byte and it was shifted out */
+        if( (sr1 & I2C_SR1_BTF) && (tx->channel->CNDTR == 0) )
+        {
+            i2c_stop(I2Cx);
+            i2c_transfer_done(I2Cx, tx, 0);
+        }
+    }
+    else if( sr1 & I2C_SR1_SB )
+    {
+        /* EV5 - SB = 1, send the slave address */
+        I2Cx->DR = xfer->slave_addr_rw;
+    }
+    else if( sr1 & I2C_SR1_ADDR )
+    {
+        /* EV6 - address matched, ADDR = 1. Clear ADDR bit */
+        I2Cx->SR2 = I2Cx->SR2;
+        /* EV8_1 - control byte goes first */
+        I2Cx->DR = xfer->ctrl_byte;
+        tx->index = 0;
+
+        if( tx->dma_enabled && (xfer->data_bytes >= I2C_DMA_MIN_BYTES) )
+        {
+            /* Payload is fed by DMA, only BTF after the last byte is of interest */
+            tx->use_dma = 1;
+            I2Cx->CR2 &= ~( I2C_CR2_ITBUFEN );
+
+            tx->channel->CCR = 0;
+            tx->channel->CPAR = (uint32_t)(uintptr_t)&I2Cx->DR;
+            tx->channel->CMAR = (uint32_t)(uintptr_t)xfer->data_buffer;
+            tx->channel->CNDTR = xfer->data_bytes;
+            tx->channel->CCR = ( DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_TEIE );
+
+            I2Cx->CR2 |= I2C_CR2_DMAEN;
+            tx->channel->CCR |= DMA_CCR1_EN;
+        }
+    }
+    else if( tx->use_dma )
+    {
+        /* EV8_2 - DMA wrote the last byte and it was shifted out */
+        if( (sr1 & I2C_SR1_BTF) && (tx->channel->CNDTR == 0) )
+        {
+            i2c_stop(I2Cx);
+            i2c_transfer_done(I2Cx, tx, 0);
+        }
+    }
+    else if( sr1 & I2C_SR1_TXE )
+    {
+        if( tx->index < xfer->data_bytes )
+        {
+            /* EV8 - next data byte */
+            I2Cx->DR = xfer->data_buffer[tx->index++];
+        }
+        else if( sr1 & I2C_SR1_BTF )
+        {
+            /* EV8_2 - all data bytes transmitted */
+            i2c_stop(I2Cx);
+            i2c_transfer_done(I2Cx, tx, 0);
+        }
+        else
+        {
+            /* Nothing left to write, wait for BTF only */
+            I2Cx->CR2 &= ~( I2C_CR2_ITBUFEN );
+        }
+    }
+}
+
+
+
+/**
+ * @brief    Abort the DMA transmission or the transaction at the queue head
+ *           on a bus error
+ * @param    none
+ * @retval   none
+ */
+static void i2c_error_handler(I2C_TypeDef* I2Cx)
+{
+    i2cTxState_t *tx = i2c_tx_lookup(I2Cx);
+    uint16_t errors = I2Cx->SR1 & ( I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO |
+                                    I2C_SR1_OVR | I2C_SR1_TIMEOUT );
+
+    /* rc_w0, only the flags read above are cleared */
+    I2Cx->SR1 = (uint16_t)~( errors );
+
+    /* After arbitration lost the peripheral is already back in slave mode */
+    if( !(errors & I2C_SR1_ARLO) )
+    {
+        i2c_stop(I2Cx);
+    }
+    i2c_transfer_done(I2Cx, tx, 1);
+}
+
+
+
+/* I2C1_TX DMA channel */
+void DMA1_Channel6_IRQHandler(void)
+{
+    i2c_dma_error(i2c_tx_state[0].i2c);
+}
+
+
+
+/* I2C2_TX DMA channel */
+void DMA1_Channel4_IRQHandler(void)
+{
+    i2c_dma_error(i2c_tx_state[1].i2c);
+}
+
+
+
+void I2C1_EV_IRQHandler(void)
+{
+    i2c_event_handler(i2c_tx_state[0].i2c);
+}
+
+
+
+void I2C1_ER_IRQHandler(void)
+{
+    i2c_error_handler(i2c_tx_state[0].i2c);
+}
+
+
+
+void I2C2_EV_IRQHandler(void)
+{
+    i2c_event_handler(i2c_tx_state[1].i2c);
+}
+
+
+
+void I2C2_ER_IRQHandler(void)
+{
+    i2c_error_handler(i2c_tx_state[1].i2c);
+}
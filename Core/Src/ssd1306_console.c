@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_console.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Scrolling text console for the SSD1306
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_console.h"
+
+
+/* GDDRAM page shown on the top screen row, cursor in screen rows */
+static uint8_t console_top;
+static uint8_t console_row;
+static uint8_t console_col;
+
+/* Columns written on each page since it was last cleared */
+static uint8_t console_used[SSD1306_CONSOLE_ROWS];
+
+
+
+static void ssd1306_console_newline(void);
+
+
+
+/**
+ * @brief    Clear the screen and start the console at the top row
+ *           Note: While the console is used the display start line is moved,
+ *                 other drawing functions work on GDDRAM pages, not screen rows.
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_consoleInit(void)
+{
+    console_top = 0;
+    console_row = 0;
+    console_col = 0;
+
+    for(uint8_t page = 0; page < SSD1306_CONSOLE_ROWS; page++)
+    {
+        console_used[page] = 0;
+    }
+
+    /* One full frame burst, cheaper than a window per page */
+    ssd1306_ramClear();
+    ssd1306_ramUpdateFull();
+    ssd1306_displayStartLine(0);
+}
+
+
+/**
+ * @brief    Write characters to the console
+ *           '\n' starts a new row, '\r' returns to the start of the row and
+ *           rows wrap after SSD1306_CONSOLE_COLS characters. Only the rows
+ *           written to are flushed. In RENDER_DEFERRED they are left to the
+ *           caller's ssd1306_flush(), the display scrolls at once.
+ * @param    buf: pointer to characters
+ * @param    len: number of characters
+ * @retval   none
+ */
+void ssd1306_consoleWrite(const char *buf, uint16_t len)
+{
+    SSD1306_RenderMode_t mode = ssd1306_getRenderMode();
+    uint8_t top = console_top;
+
+    /* The whole write reaches the display in one flush */
+    ssd1306_setRenderMode(RENDER_DEFERRED);
+
+    for(uint16_t i = 0; i < len; i++)
+    {
+        char ch[2] = { buf[i], '\0' };
+
+        if( ch[0] == '\n' )
+        {
+            ssd1306_console_newline();
+            continue;
+        }
+        if( ch[0] == '\r' )
+        {
+            console_col = 0;
+            continue;
+        }
+        if( console_col >= SSD1306_CONSOLE_COLS )
+        {
+            ssd1306_console_newline();
+        }
+
+        uint8_t page = (console_top + console_row) % SSD1306_CONSOLE_ROWS;
+
+        ssd1306_drawTextLine(page, 6 * console_col, ch);
+        console_col++;
+
+        if( console_used[page] < (6 * console_col) )
+        {
+            console_used[page] = 6 * console_col;
+        }
+    }
+
+    ssd1306_setRenderMode(mode);
+
+    /* The cleared rows are sent before they scroll into view */
+    if( mode == RENDER_IMMEDIATE )
+    {
+        ssd1306_flush();
+    }
+    if( console_top != top )
+    {
+        ssd1306_displayStartLine(8 * console_top);
+    }
+}
+
+
+/**
+ * @brief    Write a null-terminated string to the console
+ * @param    str: pointer to null-terminated string
+ * @retval   none
+ */
+void ssd1306_consolePuts(const char *str)
+{
+    uint16_t len;
+    for(len = 0; str[len] != '\0'; len++);
+
+    ssd1306_consoleWrite(str, len);
+}
+
+
+/**
+ * @brief    Move the cursor to the start of the next row, at the bottom
+ *           the oldest page is cleared and becomes the new bottom row
+ * @param    none
+ * @retval   none
+ */
+static void ssd1306_console_newline(void)
+{
+    console_col = 0;
+
+    if( console_row < (SSD1306_CONSOLE_ROWS - 1) )
+    {
+        console_row++;
+        return;
+    }
+
+    uint8_t page = console_top;
+
+    console_top = (console_top + 1) % SSD1306_CONSOLE_ROWS;
+
+    if( console_used[page] )
+    {
+        ssd1306_fillRect(0, 8 * page, console_used[page], 8, FALSE);
+        console_used[page] = 0;
+    }
+}
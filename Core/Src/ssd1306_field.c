@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_field.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Numeric field widget for the SSD1306
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_field.h"
+
+
+
+static void ssd1306_field_format(const SSD1306_Field_t *field, int32_t value, char *out);
+
+
+
+/**
+ * @brief    Initializes a SSD1306_Field_t type structure
+ *           Values are right aligned in chars cells of pitch + spacing columns.
+ *           Nothing is drawn until the first ssd1306_fieldSet().
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    x_pos: x-coordinate of the field's upper left corner
+ * @param    y_pos: y-coordinate of the field's upper left corner
+ * @param    chars: field width in characters, up to SSD1306_FIELD_MAX_CHARS
+ * @param    decimals: digits after the decimal point, 0 for integers, up to 9
+ * @retval   none
+ */
+void ssd1306_fieldInit(SSD1306_Field_t *field, const SSD1306_Font_t *text_font,
+                       int16_t x_pos, int16_t y_pos, uint8_t chars, uint8_t decimals)
+{
+    field->font = text_font;
+    field->x_pos = x_pos;
+    field->y_pos = y_pos;
+    field->chars = (chars > SSD1306_FIELD_MAX_CHARS) ? SSD1306_FIELD_MAX_CHARS : chars;
+    field->decimals = (decimals > 9) ? 9 : decimals;
+    ssd1306_fieldInvalidate(field);
+}
+
+
+/**
+ * @brief    Show a value in the field, only the cells whose character
+ *           changed are redrawn and marked dirty
+ *           The value is fixed-point: with 2 decimals 1234 shows as 12.34.
+ *           A value too wide for the field shows as all '#'.
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @param    value: value to show
+ * @retval   number of cells redrawn
+ */
+uint8_t ssd1306_fieldSet(SSD1306_Field_t *field, int32_t value)
+{
+    const SSD1306_Font_t *text_font = field->font;
+    SSD1306_RenderMode_t mode = ssd1306_getRenderMode();
+    uint8_t cell = text_font->pitch + text_font->spacing;
+    char text[SSD1306_FIELD_MAX_CHARS];
+    uint8_t redrawn = 0;
+
+    ssd1306_field_format(field, value, text);
+
+    /* Changed cells reach the display in one flush */
+    ssd1306_setRenderMode(RENDER_DEFERRED);
+
+    for(uint8_t i = 0; i < field->chars; i++)
+    {
+        if( text[i] == field->shown[i] )
+        {
+            continue;
+        }
+
+        int16_t x = field->x_pos + (i * cell);
+        char ch[2] = { text[i], '\0' };
+
+        /* Proportional glyphs do not cover the whole cell */
+        if( text_font->width )
+        {
+            ssd1306_fillRect(x, field->y_pos, cell, text_font->height, FALSE);
+        }
+        ssd1306_drawText(text_font, ch, x, field->y_pos, ROP_COPY);
+
+        field->shown[i] = text[i];
+        redrawn++;
+    }
+
+    ssd1306_setRenderMode(mode);
+    if( redrawn && (mode == RENDER_IMMEDIATE) )
+    {
+        ssd1306_flush();
+    }
+    return redrawn;
+}
+
+
+/**
+ * @brief    Forget what the field shows, the next ssd1306_fieldSet()
+ *           redraws every cell
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @retval   none
+ */
+void ssd1306_fieldInvalidate(SSD1306_Field_t *field)
+{
+    for(uint8_t i = 0; i < SSD1306_FIELD_MAX_CHARS; i++)
+    {
+        field->shown[i] = '\0';
+    }
+}
+
+
+/**
+ * @brief    Format a fixed-point value right aligned into the field width
+ * @param    field: pointer to SSD1306_Field_t type structure
+ * @param    value: value to format
+ * @param    out: receives field->chars characters, not null-terminated
+ * @retval   none
+ */
+static void ssd1306_field_format(const SSD1306_Field_t *field, int32_t value, char *out)
+{
+    uint32_t magnitude = (value < 0) ? (0U - (uint32_t)value) : (uint32_t)value;
+    char reversed[12];
+    uint8_t len = 0;
+
+    /* Digits from the right, at least one before the decimal point */
+    do
+    {
+        if( field->decimals && (len == field->decimals) )
+        {
+            reversed[len++] = '.';
+        }
+        reversed[len++] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while( magnitude || (len <= field->decimals) );
+
+    if( value < 0 )
+    {
+        reversed[len++] = '-';
+    }
+
+    if( len > field->chars )
+    {
+        for(uint8_t i = 0; i < field->chars; i++)
+        {
+            out[i] = '#';
+        }
+        return;
+    }
+
+    uint8_t pad = field->chars - len;
+
+    for(uint8_t i = 0; i < pad; i++)
+    {
+        out[i] = ' ';
+    }
+    for(uint8_t i = 0; i < len; i++)
+    {
+        out[pad + i] = reversed[len - 1 - i];
+    }
+}
@@ -0,0 +1,346 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_label.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Cache of rendered text labels
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_label.h"
+
+
+typedef struct
+{
+    const SSD1306_Font_t *font;
+    uint32_t hash;
+    uint32_t last_used;         /* value of label_clock at the last hit, 0 if free */
+    uint8_t style;
+    uint8_t width;
+    uint8_t height;
+    char text[SSD1306_LABEL_TEXT_SIZE];
+    uint8_t bitmap[SSD1306_LABEL_SLOT_SIZE];
+} SSD1306_Label_t;
+
+
+static SSD1306_Label_t label_slot[SSD1306_LABEL_SLOTS];
+static uint32_t label_clock;
+static uint32_t label_hits;
+static uint32_t label_misses;
+
+
+
+static uint32_t ssd1306_label_hash(const char *str);
+static uint8_t ssd1306_label_match(const char *text, const char *str);
+static uint8_t ssd1306_label_fits(const SSD1306_Font_t *text_font, const char *str);
+static void ssd1306_label_raster(SSD1306_Label_t *label, const char *str);
+static SSD1306_Rect_t ssd1306_label_uncached(const SSD1306_Font_t *text_font, const char *str,
+                                             int16_t x_pos, int16_t y_pos, uint8_t style);
+
+
+
+/**
+ * @brief    Draw a string through the label cache
+ *           The label is looked up by string, font and style. A hit is a
+ *           single ssd1306_blit(), a miss rasterises the string into the least
+ *           recently used slot first. Labels larger than a slot or longer than
+ *           SSD1306_LABEL_TEXT_SIZE - 1 characters are drawn with
+ *           ssd1306_drawText() and not cached.
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @param    x_pos: x-coordinate of the label's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the label's upper left corner, can be negative
+ * @param    style: LABEL_NORMAL, or LABEL_INVERSE and/or LABEL_UNDERLINE
+ * @retval   the on-screen area that was drawn, width 0 if fully clipped
+ */
+SSD1306_Rect_t ssd1306_drawLabel(const SSD1306_Font_t *text_font, const char *str,
+                                 int16_t x_pos, int16_t y_pos, uint8_t style)
+{
+    uint32_t hash = ssd1306_label_hash(str);
+    SSD1306_Label_t *label = 0;
+    SSD1306_Label_t *oldest = &label_slot[0];
+
+    for(uint8_t i = 0; i < SSD1306_LABEL_SLOTS; i++)
+    {
+        SSD1306_Label_t *slot = &label_slot[i];
+
+        if( slot->last_used && (slot->hash == hash) && (slot->font == text_font) &&
+            (slot->style == style) && ssd1306_label_match(slot->text, str) )
+        {
+            label = slot;
+            break;
+        }
+        if( slot->last_used < oldest->last_used )
+        {
+            oldest = slot;
+        }
+    }
+
+    if( label )
+    {
+        label_hits++;
+    }
+    else
+    {
+        label_misses++;
+
+        /* Checked before a slot is claimed, a label that is not cached
+           must not evict one that is */
+        if( !ssd1306_label_fits(text_font, str) )
+        {
+            return ssd1306_label_uncached(text_font, str, x_pos, y_pos, style);
+        }
+
+        label = oldest;
+        label->font = text_font;
+        label->hash = hash;
+        label->style = style;
+        ssd1306_label_raster(label, str);
+    }
+    label->last_used = ++label_clock;
+
+    ssd1306_blit(label->bitmap, label->width, label->height, x_pos, y_pos, ROP_COPY);
+
+    /* Clip the drawn area to the display */
+    SSD1306_Rect_t area = { 0, 0, 0, 0 };
+    int16_t x_start = (x_pos < 0) ? 0 : x_pos;
+    int16_t x_end = x_pos + label->width;
+    int16_t y_start = (y_pos < 0) ? 0 : y_pos;
+    int16_t y_end = y_pos + label->height;
+
+    x_end = (x_end > SSD1306_WIDTH) ? SSD1306_WIDTH : x_end;
+    y_end = (y_end > SSD1306_HEIGHT) ? SSD1306_HEIGHT : y_end;
+
+    if( (x_start < x_end) && (y_start < y_end) )
+    {
+        area.x_pos = x_start;
+        area.y_pos = y_start;
+        area.width = x_end - x_start;
+        area.height = y_end - y_start;
+    }
+    return area;
+}
+
+
+/**
+ * @brief    Drop every cached label, the hit counters are kept
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_labelFlush(void)
+{
+    for(uint8_t i = 0; i < SSD1306_LABEL_SLOTS; i++)
+    {
+        label_slot[i].last_used = 0;
+    }
+}
+
+
+/**
+ * @brief    Read the label cache statistics
+ * @param    stats: pointer to SSD1306_LabelStats_t type structure to fill
+ * @retval   none
+ */
+void ssd1306_labelGetStats(SSD1306_LabelStats_t *stats)
+{
+    uint16_t used = 0;
+
+    for(uint8_t i = 0; i < SSD1306_LABEL_SLOTS; i++)
+    {
+        if( label_slot[i].last_used )
+        {
+            used += label_slot[i].width * ((label_slot[i].height + 7) / 8);
+        }
+    }
+
+    stats->hits = label_hits;
+    stats->misses = label_misses;
+    stats->bytes = used;
+    stats->pool = sizeof(label_slot);
+}
+
+
+/**
+ * @brief    32-bit FNV-1a hash of a string
+ * @param    str: pointer to null-terminated string
+ * @retval   hash value
+ */
+static uint32_t ssd1306_label_hash(const char *str)
+{
+    uint32_t hash = 2166136261U;
+
+    for(; *str != '\0'; str++)
+    {
+        hash = (hash ^ (uint8_t)*str) * 16777619U;
+    }
+    return hash;
+}
+
+
+/**
+ * @brief    Compare a cached string with a string to draw
+ * @param    text: pointer to the string kept in a slot
+ * @param    str: pointer to null-terminated string
+ * @retval   1 if they are equal, 0 if not
+ */
+static uint8_t ssd1306_label_match(const char *text, const char *str)
+{
+    for(; *text == *str; text++, str++)
+    {
+        if( *text == '\0' )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief    Check if a string can be cached, its bitmap fits a slot and
+ *           the string fits the slot's copy
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @retval   1 if it fits, 0 if not
+ */
+static uint8_t ssd1306_label_fits(const SSD1306_Font_t *text_font, const char *str)
+{
+    uint8_t pages = (text_font->height + 7) / 8;
+    uint16_t width = ssd1306_textWidth(text_font, str);
+    uint8_t len;
+
+    for(len = 0; (len < SSD1306_LABEL_TEXT_SIZE) && (str[len] != '\0'); len++);
+
+    return (width != 0) && (width <= SSD1306_WIDTH) && ((width * pages) <= SSD1306_LABEL_SLOT_SIZE) &&
+           (len < SSD1306_LABEL_TEXT_SIZE);
+}
+
+
+/**
+ * @brief    Rasterise a string into a slot, page-major with its top row at
+ *           bit 0, then apply the slot's style
+ *           Note: ssd1306_label_fits() must have accepted the string.
+ * @param    label: pointer to the slot, font and style already set
+ * @param    str: pointer to null-terminated string
+ * @retval   none
+ */
+static void ssd1306_label_raster(SSD1306_Label_t *label, const char *str)
+{
+    const SSD1306_Font_t *text_font = label->font;
+    uint8_t pages = (text_font->height + 7) / 8;
+    uint16_t width = ssd1306_textWidth(text_font, str);
+
+    label->width = width;
+    label->height = text_font->height;
+
+    for(uint8_t i = 0; (label->text[i] = str[i]) != '\0'; i++);
+
+    uint8_t col = 0;
+
+    for(; *str != '\0'; str++)
+    {
+        uint8_t ch = (uint8_t)*str;
+        uint8_t index = ((ch >= text_font->first) && (ch <= text_font->last)) ? (ch - text_font->first) : 0;
+        uint8_t glyph_width = text_font->width ? text_font->width[index] : text_font->pitch;
+        const uint8_t *glyph = text_font->width ? (text_font->glyphs + text_font->offset[index])
+                                                : (text_font->glyphs + (index * text_font->pitch * pages));
+
+        for(uint8_t page = 0; page < pages; page++)
+        {
+            uint8_t *dst = label->bitmap + (width * page) + col;
+
+            for(uint8_t i = 0; i < glyph_width; i++)
+            {
+                dst[i] = glyph[(glyph_width * page) + i];
+            }
+            for(uint8_t i = 0; i < text_font->spacing; i++)
+            {
+                dst[glyph_width + i] = 0x00;
+            }
+        }
+        col += glyph_width + text_font->spacing;
+    }
+
+    if( label->style & LABEL_UNDERLINE )
+    {
+        uint8_t *row = label->bitmap + (width * ((label->height - 1) / 8));
+
+        for(uint8_t i = 0; i < width; i++)
+        {
+            row[i] |= 1U << ((label->height - 1) % 8);
+        }
+    }
+    if( label->style & LABEL_INVERSE )
+    {
+        for(uint16_t i = 0; i < (width * pages); i++)
+        {
+            label->bitmap[i] ^= 0xFF;
+        }
+    }
+}
+
+
+/**
+ * @brief    Draw a label that is not cached with ssd1306_drawText(), then
+ *           apply the style over the drawn area like ssd1306_label_raster()
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @param    x_pos: x-coordinate of the label's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the label's upper left corner, can be negative
+ * @param    style: LABEL_NORMAL, or LABEL_INVERSE and/or LABEL_UNDERLINE
+ * @retval   the on-screen area that was drawn, width 0 if fully clipped
+ */
+static SSD1306_Rect_t ssd1306_label_uncached(const SSD1306_Font_t *text_font, const char *str,
+                                             int16_t x_pos, int16_t y_pos, uint8_t style)
+{
+    SSD1306_RenderMode_t mode = ssd1306_getRenderMode();
+    uint8_t underline[SSD1306_FONT_MAX_HEIGHT / 8] = { 0 };
+    uint8_t inverse[SSD1306_FONT_MAX_HEIGHT / 8];
+
+    /* One column of each style, ORed and XORed over every drawn column */
+    for(uint8_t i = 0; i < sizeof(inverse); i++)
+    {
+        inverse[i] = 0xFF;
+    }
+    underline[(text_font->height - 1) / 8] = 1U << ((text_font->height - 1) % 8);
+
+    /* Text and style reach the display in one flush */
+    ssd1306_setRenderMode(RENDER_DEFERRED);
+
+    SSD1306_Rect_t area = ssd1306_drawText(text_font, str, x_pos, y_pos, ROP_COPY);
+
+    for(uint8_t i = 0; i < area.width; i++)
+    {
+        if( style & LABEL_UNDERLINE )
+        {
+            ssd1306_blit(underline, 1, text_font->height, area.x_pos + i, y_pos, ROP_OR);
+        }
+        if( style & LABEL_INVERSE )
+        {
+            ssd1306_blit(inverse, 1, text_font->height, area.x_pos + i, y_pos, ROP_XOR);
+        }
+    }
+
+    ssd1306_setRenderMode(mode);
+    if( mode == RENDER_IMMEDIATE )
+    {
+        ssd1306_flush();
+    }
+
+    return area;
+}
@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_log.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Interrupt-safe log sink for the SSD1306 console
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_log.h"
+
+
+/* Writers claim space by moving log_reserve and copy into it, log_head
+   is what the consumer may read. It catches up with log_reserve when the
+   last writer in progress is done, so overlapping writers hold back what
+   the others queued until the last one finishes. log_tail is only written
+   by the consumer */
+static char log_ring[SSD1306_LOG_SIZE];
+static volatile uint16_t log_reserve;
+static volatile uint16_t log_head;
+static volatile uint16_t log_tail;
+static volatile uint8_t log_writers;
+static volatile uint32_t log_dropped;
+
+
+
+/**
+ * @brief    Queue characters for the console, never blocks
+ *           Safe to call from the main loop and from interrupts of any
+ *           priority at the same time. Characters that do not fit are dropped.
+ * @param    buf: pointer to characters
+ * @param    len: number of characters
+ * @retval   number of characters queued
+ */
+uint16_t ssd1306_logWrite(const char *buf, uint16_t len)
+{
+    /* An interrupt writing meanwhile claims the space after this one */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint16_t start = log_reserve;
+    uint16_t space = SSD1306_LOG_SIZE - (uint16_t)(start - log_tail);
+    uint16_t count = (len < space) ? len : space;
+
+    log_reserve = start + count;
+    log_writers++;
+    log_dropped += len - count;
+
+    __set_PRIMASK(primask);
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        log_ring[(start + i) & (SSD1306_LOG_SIZE - 1)] = buf[i];
+    }
+
+    /* Characters are in the ring before the consumer can see them */
+    __DMB();
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* A writer that was interrupted still copies into space before
+       log_reserve, the last one to finish publishes for all */
+    if( --log_writers == 0 )
+    {
+        log_head = log_reserve;
+    }
+
+    __set_PRIMASK(primask);
+
+    return count;
+}
+
+
+/**
+ * @brief    Move the queued characters to the console, call from the
+ *           main loop. Only the console rows written to are flushed.
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_logDrain(void)
+{
+    uint16_t tail = log_tail;
+    uint16_t head = log_head;
+
+    __DMB();
+
+    while( tail != head )
+    {
+        uint16_t index = tail & (SSD1306_LOG_SIZE - 1);
+        uint16_t count = (uint16_t)(head - tail);
+
+        /* Up to the end of the ring, the rest on the next pass */
+        if( count > (SSD1306_LOG_SIZE - index) )
+        {
+            count = SSD1306_LOG_SIZE - index;
+        }
+
+        ssd1306_consoleWrite(&log_ring[index], count);
+        tail += count;
+
+        __DMB();
+        log_tail = tail;
+    }
+}
+
+
+/**
+ * @brief    Number of characters dropped because the ring was full
+ * @param    none
+ * @retval   dropped characters since reset
+ */
+uint32_t ssd1306_logDropped(void)
+{
+    return log_dropped;
+}
+
+
+/**
+ * @brief    newlib system call behind printf() and puts(), stdout and
+ *           stderr go to ssd1306_logWrite()
+ *           Note: printf() itself is not reentrant, call ssd1306_logWrite()
+ *                 directly from interrupts.
+ * @param    file: file descriptor, 1 or 2
+ * @param    ptr: pointer to characters
+ * @param    len: number of characters
+ * @retval   len, or -1 for any other file
+ */
+int _write(int file, char *ptr, int len)
+{
+    if( (file != 1) && (file != 2) )
+    {
+        return -1;
+    }
+
+    /* What does not fit is dropped, reporting it would only make
+       newlib retry */
+    ssd1306_logWrite(ptr, (len > 0xFFFF) ? 0xFFFF : (uint16_t)len);
+    return len;
+}
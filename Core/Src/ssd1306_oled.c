@@ -29,14 +29,152 @@
 **/
 
 #include "ssd1306_oled.h"
+#include "delay.h"
 
 
 /* Ram space that simulate the display's GDDRAM */
 static uint8_t ssd1306_ram[1024] __attribute__((aligned(4)));
 static uint8_t *p_ram = ssd1306_ram;
 
+/* Per page column range touched since the last flush,
+   dirty_start > dirty_end marks a clean page */
+static uint8_t dirty_start[8] = { SSD1306_WIDTH, SSD1306_WIDTH, SSD1306_WIDTH, SSD1306_WIDTH,
+                                  SSD1306_WIDTH, SSD1306_WIDTH, SSD1306_WIDTH, SSD1306_WIDTH };
+static uint8_t dirty_end[8];
+
+#if (SSD1306_DOUBLE_BUFFER)
+/* Front buffer, owned by the background transfer while it is in flight */
+static uint8_t ssd1306_ram_front[1024] __attribute__((aligned(4)));
+static uint8_t *p_front = ssd1306_ram_front;
+#endif
+
+#if (SSD1306_USE_SHADOW)
+/* Copy of what is known to be on the display, used by FLUSH_SHADOW */
+static uint8_t ssd1306_shadow[1024] __attribute__((aligned(4)));
+static uint8_t shadow_valid;
+#endif
+
+#if (SSD1306_USE_CRC)
+/* Signature of every 16 column block of each page as sent, used by FLUSH_CRC */
+static uint32_t ssd1306_crc[64];
+static uint8_t crc_valid;
+#endif
+
+/* Bytes on the wire to open a new window before a run of data:
+   [ADDR] [CMD] 0x21 c0 c1 0x22 p0 p1 + [ADDR] [DATA], or with the Co bit
+   [ADDR] 6 x (0x80 cmd) [DATA] */
+#if (SSD1306_USE_CO_BIT)
+#define SSD1306_WINDOW_COST         14U
+#else
+#define SSD1306_WINDOW_COST         10U
+#endif
+
+/* Bytes on the wire of a full update, cursor move included */
+#define SSD1306_FRAME_COST          ( 8U + 2U + 1024U )
+
+/* Bits of a page byte from row n downwards, and from row 0 to row n */
+static const uint8_t span_mask_start[8] = { 0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80 };
+static const uint8_t span_mask_end[8]   = { 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF };
+
+/* Controller GDDRAM window and address pointer as last programmed, only
+   tracked in horizontal addressing mode so window setups can be skipped */
+static uint8_t addr_valid;
+static uint8_t addr_horizontal;
+static uint8_t addr_col;
+static uint8_t addr_page;
+static uint8_t win_col_start;
+static uint8_t win_col_end;
+static uint8_t win_page_start;
+static uint8_t win_page_end;
+
+/* Set when a polled transaction gave up waiting for the bus, the display and
+   the state tracked here are out of step until ssd1306_resync() */
+static uint8_t bus_dropped;
+
+/* Controller registers as last sent, each holds the command byte or value
+   written so unchanged settings are not sent again */
+static uint8_t regs_valid;
+static uint8_t reg_contrast;
+static uint8_t reg_invert;
+static uint8_t reg_on;
+static uint8_t reg_addr_mode;
+static uint8_t reg_seg_remap;
+static uint8_t reg_com_scan;
+static uint8_t reg_start_line;
+static uint8_t reg_scroll;
+static uint8_t reg_scroll_area;
+static uint8_t reg_scroll_setup[7];
+static uint8_t reg_scroll_setup_len;
+
+/* Commands collected between ssd1306_cmdBegin() and ssd1306_cmdEnd() */
+static uint8_t cmd_batch[SSD1306_CMD_BATCH_SIZE];
+static uint8_t cmd_batch_len;
+static uint8_t cmd_batch_depth;
+
+static SSD1306_FlushMode_t flush_mode = FLUSH_DIRTY;
+static SSD1306_RenderMode_t render_mode = RENDER_IMMEDIATE;
+static SSD1306_Stats_t ssd1306_stats;
+
+/* Sent by ssd1306_initSplash() in one transaction, the display is left off.
+   The register cache seeded there must match */
+static const uint8_t ssd1306_init_seq[] =
+{
+    0xAE,                       /* Entire Display OFF */
+    0xD5, 0xF0,                 /* Display Clock Divide Ratio and Oscillator Frequency, recommended setting */
+    0xD9, 0xF1,                 /* Pre-charge period, Phase 1 of 15 DCLK, Phase 2 of 1 DCLK */
+    0xDB, 0x20,                 /* Vcomh deselect level ~ 0.77 Vcc */
+    0x8D, 0x14,                 /* Enable charge pump during display on */
+    0x20, HORIZONTAL_MODE,      /* Memory addressing mode */
+    0x40,                       /* Display Start Line 0 */
+    0xA1,                       /* Segment Re-map, x axis */
+    0xA8, SSD1306_HEIGHT - 1,   /* Multiplex Ratio, 64 COM lines */
+    0xC8,                       /* COM Output scan direction COM63 - COM0, y axis */
+    0xD3, 0x00,                 /* Display offset 0 */
+    0xDA, 0x12,                 /* Alternative com pin configuration, disable com left/right remap */
+    0x81, 0x80,                 /* Contrast 128 */
+    0xA4,                       /* Entire display ON, resume to RAM content display */
+    0xA6,                       /* Normal Mode */
+    0x2E,                       /* Deactivate scroll */
+    0x21, 0x00, 0x7F,           /* Full window, address pointer at column 0 of PAGE0 */
+    0x22, PAGE0, PAGE7
+};
+
 static void ssd1306_cmd_single(uint8_t cmd);
 static void ssd1306_cmd_double(uint8_t cmd, uint8_t val);
+static void ssd1306_cmd_list(const uint8_t *cmd, uint8_t len);
+static void ssd1306_cmd_batch_send(void);
+static void ssd1306_data_burst(const uint8_t *data, uint16_t len);
+static uint8_t ssd1306_i2c_start(void);
+static void ssd1306_i2c_stop(void);
+static void ssd1306_queue_frame(const uint8_t *frame, SSD1306_Callback_t callback);
+static void ssd1306_set_window(uint8_t col_start, uint8_t col_end, uint8_t page_start, uint8_t page_end);
+static uint16_t ssd1306_window_burst(uint8_t col_start, uint8_t col_end, uint8_t page_start, uint8_t page_end,
+                                     const uint8_t *data, uint16_t len);
+static void ssd1306_addr_window(uint8_t col_start, uint8_t col_end, uint8_t page_start, uint8_t page_end);
+static uint8_t ssd1306_addr_ready(uint8_t col, uint8_t page, uint16_t len);
+static void ssd1306_addr_advance(uint16_t len);
+static void ssd1306_reg_single(uint8_t *reg, uint8_t cmd);
+static void ssd1306_reg_double(uint8_t *reg, uint8_t cmd, uint8_t val);
+static uint8_t ssd1306_reg_scroll_setup(const uint8_t *cmd, uint8_t len);
+static void ssd1306_mark_dirty(uint8_t page, uint8_t col_start, uint8_t col_end);
+static void ssd1306_mark_clean(void);
+static void ssd1306_ram_pixel(uint8_t x_pos, uint8_t y_pos, SSD1306_FunctionalState_t state);
+static void ssd1306_render_end(void);
+static void ssd1306_span_h(uint8_t page, uint8_t x_pos1, uint8_t x_pos2, uint8_t mask, SSD1306_FunctionalState_t state);
+static void ssd1306_span_fill(uint8_t x_pos1, uint8_t y_pos1, uint8_t x_pos2, uint8_t y_pos2, SSD1306_FunctionalState_t state);
+static inline void ssd1306_rop_byte(uint8_t *dst, uint8_t src, uint8_t mask, SSD1306_Rop_t rop);
+static uint16_t ssd1306_send_run(uint8_t page, uint8_t col_start, uint8_t col_end);
+static uint16_t ssd1306_send_span(uint8_t page, uint8_t col_start, uint8_t col_end);
+static void ssd1306_sync_frame(const uint8_t *frame);
+static void ssd1306_sync_byte(uint16_t byte_pos);
+static void ssd1306_sync_lost(void);
+#if (SSD1306_USE_SHADOW)
+static uint16_t ssd1306_flush_shadow(void);
+#endif
+#if (SSD1306_USE_CRC)
+static uint32_t ssd1306_crc_block(const uint8_t *block);
+static uint16_t ssd1306_flush_crc(void);
+#endif
 
 
 
@@ -50,37 +188,173 @@ void ssd1306_drawChar(const char *ch)
     uint32_t len;
     for(len = 0; ch[len] != '\0'; len++);
 
+    if( !len )
+    {
+        return;
+    }
+
+    /* One claim of the bus, every byte after the first is a repeated start */
+    if( !ssd1306_i2c_start() )
+    {
+        return;
+    }
+
     for(uint32_t bitpos = 0; bitpos < len; bitpos++)
     {
         for(uint32_t bitmap = 0; bitmap < 5; bitmap++)
         {
-            i2c_start(SSD1306_I2Cx);
-            i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
+            if( bitpos || bitmap )
+            {
+                i2c_start(SSD1306_I2Cx);
+                i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
+            }
             i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
             i2c_write(SSD1306_I2Cx, font[ch[ bitpos ] - 0x20] [bitmap] );
         }
     }
-    i2c_stop(SSD1306_I2Cx);
+    ssd1306_i2c_stop();
+    ssd1306_addr_advance(5 * len);
+
+    /* Written at the controller's cursor, the GDDRAM copy no longer
+       knows what is on the display */
+    ssd1306_sync_lost();
 }
 
 
 /**
  * @brief    Prints a bitmap to the entire display
+ *           The bitmap is copied into the GDDRAM, drawing continues on top of it.
  * @param    bitmap: pointer to bitmap
  * @retval   none
  */
 void ssd1306_drawBitmap(const uint8_t *bitmap)
 {
-    ssd1306_displayMoveCursor(0, 0);
-
+    /* Copied first so the flush modes that compare against the display
+       find the bitmap in the GDDRAM copy too */
     for(uint16_t i = 0; i < 1024; i++)
     {
-        i2c_start(SSD1306_I2Cx);
-        i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-        i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
-        i2c_write(SSD1306_I2Cx, bitmap[i]);
+        *(p_ram + i) = bitmap[i];
+    }
+
+    ssd1306_ramUpdateFull();
+}
+
+
+/**
+ * @brief    Copy a bitmap of any size to any position on the display
+ *           The bitmap is page-major like the GDDRAM: each byte is a column of
+ *           8 rows, the first width bytes hold rows 0..7, the next width bytes
+ *           rows 8..15 and so on. Parts outside the display are clipped.
+ * @param    src: pointer to bitmap, width * ((height + 7) / 8) bytes
+ * @param    width: bitmap width in pixels
+ * @param    height: bitmap height in pixels, rows past it in the last page are ignored
+ * @param    x_pos: x-coordinate of the bitmap's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the bitmap's upper left corner, can be negative
+ * @param    rop: how bitmap pixels combine with the display, any one of SSD1306_Rop_t
+ *                ROP_COPY, ROP_OR, ROP_AND, ROP_XOR, ROP_ANDNOT (clears the set pixels)
+ * @retval   none
+ */
+void ssd1306_blit(const uint8_t *src, uint8_t width, uint8_t height, int16_t x_pos, int16_t y_pos, SSD1306_Rop_t rop)
+{
+    int16_t col_start = (x_pos < 0) ? -x_pos : 0;
+    int16_t col_end = ( (x_pos + width) > SSD1306_WIDTH ) ? (SSD1306_WIDTH - x_pos) : width;
+    uint8_t src_pages = (height + 7) / 8;
+
+    /* Rows are shifted into a 16-bit pair of destination pages */
+    int16_t page_base = (y_pos >= 0) ? (y_pos / 8) : -((7 - y_pos) / 8);
+    uint8_t shift = y_pos - (8 * page_base);
+
+    for(uint8_t src_page = 0; (src_page < src_pages) && (col_start < col_end); src_page++)
+    {
+        int16_t dst_page = page_base + src_page;
+        uint8_t rows = 0xFF;
+
+        if( (src_page == (src_pages - 1)) && (height % 8) )
+        {
+            rows = span_mask_end[(height % 8) - 1];
+        }
+
+        uint16_t mask = (uint16_t)rows << shift;
+        uint8_t lo_valid = (dst_page >= 0) && (dst_page < 8) && (mask & 0x00FF);
+        uint8_t hi_valid = (dst_page >= -1) && (dst_page < 7) && (mask & 0xFF00);
+        /* Byte index of column 0, negative off the top or left edge. Only
+           turned into a pointer once the byte is known to be inside */
+        int16_t lo = (128 * dst_page) + x_pos;
+        const uint8_t *row = src + (width * src_page);
+
+        for(int16_t col = col_start; col < col_end; col++)
+        {
+            uint16_t bits = (uint16_t)row[col] << shift;
+
+            if( lo_valid )
+            {
+                ssd1306_rop_byte(&p_ram[lo + col], bits, mask, rop);
+            }
+            if( hi_valid )
+            {
+                ssd1306_rop_byte(&p_ram[lo + 128 + col], bits >> 8, mask >> 8, rop);
+            }
+        }
+
+        if( lo_valid )
+        {
+            ssd1306_mark_dirty(dst_page, x_pos + col_start, x_pos + col_end - 1);
+        }
+        if( hi_valid )
+        {
+            ssd1306_mark_dirty(dst_page + 1, x_pos + col_start, x_pos + col_end - 1);
+        }
+    }
+    ssd1306_render_end();
+}
+
+
+/**
+ * @brief    Copy an area of the GDDRAM into a bitmap, the reverse of ssd1306_blit()
+ *           The bitmap is page-major with its row 0 at bit 0 of the first width
+ *           bytes. Pixels outside the display read as 0.
+ * @param    dst: pointer to bitmap, width * ((height + 7) / 8) bytes
+ * @param    width: area width in pixels
+ * @param    height: area height in pixels
+ * @param    x_pos: x-coordinate of the area's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the area's upper left corner, can be negative
+ * @retval   none
+ */
+void ssd1306_ramRead(uint8_t *dst, uint8_t width, uint8_t height, int16_t x_pos, int16_t y_pos)
+{
+    uint8_t dst_pages = (height + 7) / 8;
+    int16_t page_base = (y_pos >= 0) ? (y_pos / 8) : -((7 - y_pos) / 8);
+    uint8_t shift = y_pos - (8 * page_base);
+
+    for(uint8_t dst_page = 0; dst_page < dst_pages; dst_page++)
+    {
+        int16_t page = page_base + dst_page;
+        uint8_t rows = 0xFF;
+
+        if( (dst_page == (dst_pages - 1)) && (height % 8) )
+        {
+            rows = span_mask_end[(height % 8) - 1];
+        }
+
+        for(uint8_t col = 0; col < width; col++)
+        {
+            int16_t x = x_pos + col;
+            uint16_t bits = 0;
+
+            if( (x >= 0) && (x < SSD1306_WIDTH) )
+            {
+                if( (page >= 0) && (page < 8) )
+                {
+                    bits = p_ram[(128 * page) + x];
+                }
+                if( (page >= -1) && (page < 7) )
+                {
+                    bits |= (uint16_t)p_ram[(128 * (page + 1)) + x] << 8;
+                }
+            }
+            dst[(width * dst_page) + col] = (bits >> shift) & rows;
+        }
     }
-    i2c_stop(SSD1306_I2Cx);
 }
 
 
@@ -92,14 +366,8 @@ void ssd1306_drawBitmap(const uint8_t *bitmap)
  */
 void ssd1306_drawPixel(uint8_t x_pos, uint8_t y_pos)
 {
-    ssd1306_displayMoveCursor(x_pos, y_pos / 8);
-    uint16_t byte_pos = x_pos + (128 * ( y_pos / 8) );
-
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
-    i2c_write(SSD1306_I2Cx, *(p_ram + byte_pos) |= (0x01 << (y_pos % 8) )  );
-    i2c_stop(SSD1306_I2Cx);
+    ssd1306_ram_pixel(x_pos, y_pos, TRUE);
+    ssd1306_render_end();
 }
 
 
@@ -109,16 +377,10 @@ void ssd1306_drawPixel(uint8_t x_pos, uint8_t y_pos)
  * @param    y_pos: y-coordinate of pixel
  * @retval   none
  */
-void ssd1306_displayClearPixel(uint8_t x_pos, uint8_t y_pos)
+void ssd1306_clearPixel(uint8_t x_pos, uint8_t y_pos)
 {
-    ssd1306_displayMoveCursor(x_pos, y_pos / 8);
-    uint16_t byte_pos = x_pos + (128 * ( y_pos / 8) );
-
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
-    i2c_write(SSD1306_I2Cx, *(p_ram + byte_pos) = (0x00 << (y_pos % 8) )  );
-    i2c_stop(SSD1306_I2Cx);
+    ssd1306_ram_pixel(x_pos, y_pos, FALSE);
+    ssd1306_render_end();
 }
 
 
@@ -163,7 +425,7 @@ void ssd1306_drawLine(uint8_t x_pos1, uint8_t y_pos1, uint8_t x_pos2, uint8_t y_
         pk = dy2 - dx;
         while( x_pos1 != x_pos2)
         {
-            ssd1306_drawPixel(x_pos1, y_pos1);
+            ssd1306_ram_pixel(x_pos1, y_pos1, TRUE);
             x_pos1 = x_pos1 + dx_sym;
 
             if(pk < 0)
@@ -183,7 +445,7 @@ void ssd1306_drawLine(uint8_t x_pos1, uint8_t y_pos1, uint8_t x_pos2, uint8_t y_
         pk = dx2 - dy;
         while( y_pos1 != y_pos2)
         {
-            ssd1306_drawPixel(x_pos1, y_pos1);
+            ssd1306_ram_pixel(x_pos1, y_pos1, TRUE);
             y_pos1 = y_pos1 + dy_sym;
 
             if(pk < 0)
@@ -198,7 +460,8 @@ void ssd1306_drawLine(uint8_t x_pos1, uint8_t y_pos1, uint8_t x_pos2, uint8_t y_
             }
         }
     }
-    ssd1306_drawPixel(x_pos1, y_pos1);
+    ssd1306_ram_pixel(x_pos1, y_pos1, TRUE);
+    ssd1306_render_end();
 }
 
 
@@ -211,26 +474,22 @@ void ssd1306_drawLine(uint8_t x_pos1, uint8_t y_pos1, uint8_t x_pos2, uint8_t y_
  */
 void ssd1306_drawVerticalLine(uint8_t x_pos, uint8_t y_pos1, uint8_t y_pos2)
 {
-    int8_t y_dist;
-    
-    if(y_pos2 > y_pos1)
+    if( y_pos1 > y_pos2 )
     {
-        y_dist = y_pos2 - y_pos1;
-
-        for(uint8_t i = 0; i <= (uint8_t)y_dist; i++)
-        {
-            ssd1306_drawPixel(x_pos, y_pos1 + i);
-        }
+        uint8_t tmp = y_pos1;
+        y_pos1 = y_pos2;
+        y_pos2 = tmp;
     }
 
-    else
+    if( (x_pos < SSD1306_WIDTH) && (y_pos1 < SSD1306_HEIGHT) )
     {
-        y_dist = y_pos1 - y_pos2;
-        for(uint8_t i = 0; i <= (uint8_t)y_dist; i++)
+        if( y_pos2 >= SSD1306_HEIGHT )
         {
-            ssd1306_drawPixel(x_pos, y_pos1 - i);
+            y_pos2 = SSD1306_HEIGHT - 1;
         }
+        ssd1306_span_fill(x_pos, y_pos1, x_pos, y_pos2, TRUE);
     }
+    ssd1306_render_end();
 }
 
 
@@ -243,26 +502,52 @@ void ssd1306_drawVerticalLine(uint8_t x_pos, uint8_t y_pos1, uint8_t y_pos2)
  */
 void ssd1306_drawHorizontalLine(uint8_t y_pos, uint8_t x_pos1, uint8_t x_pos2)
 {
-    int8_t x_dist;
-
-    if(x_pos2 > x_pos1)
+    if( x_pos1 > x_pos2 )
     {
-        x_dist = x_pos2 - x_pos1;
+        uint8_t tmp = x_pos1;
+        x_pos1 = x_pos2;
+        x_pos2 = tmp;
+    }
 
-        for(uint8_t i = 0; i <= (uint8_t)x_dist; i++)
+    if( (y_pos < SSD1306_HEIGHT) && (x_pos1 < SSD1306_WIDTH) )
+    {
+        if( x_pos2 >= SSD1306_WIDTH )
         {
-            ssd1306_drawPixel(x_pos1 + i, y_pos);
+            x_pos2 = SSD1306_WIDTH - 1;
         }
+        ssd1306_span_fill(x_pos1, y_pos, x_pos2, y_pos, TRUE);
     }
-    else
+    ssd1306_render_end();
+}
+
+
+/**
+ * @brief    Fill or clear a rectangle anywhere on the display, clipped at the edges
+ * @param    x_pos: x-coordinate of the upper left corner
+ * @param    y_pos: y-coordinate of the upper left corner
+ * @param    width: rectangle width in pixels
+ * @param    height: rectangle height in pixels
+ * @param    state: TRUE to set the pixels, FALSE to clear them
+ * @retval   none
+ */
+void ssd1306_fillRect(uint8_t x_pos, uint8_t y_pos, uint8_t width, uint8_t height, SSD1306_FunctionalState_t state)
+{
+    if( (width != 0) && (height != 0) && (x_pos < SSD1306_WIDTH) && (y_pos < SSD1306_HEIGHT) )
     {
-        x_dist = x_pos1 - x_pos2;
+        uint16_t x_end = x_pos + width - 1;
+        uint16_t y_end = y_pos + height - 1;
 
-        for(uint8_t i = 0; i <= (uint8_t)x_dist; i++)
+        if( x_end >= SSD1306_WIDTH )
+        {
+            x_end = SSD1306_WIDTH - 1;
+        }
+        if( y_end >= SSD1306_HEIGHT )
         {
-            ssd1306_drawPixel(x_pos1 - i, y_pos);
+            y_end = SSD1306_HEIGHT - 1;
         }
+        ssd1306_span_fill(x_pos, y_pos, x_end, y_end, state);
     }
+    ssd1306_render_end();
 }
 
 
@@ -301,49 +586,49 @@ void ssd1306_drawCircle(uint8_t x_cen, uint8_t y_cen, uint8_t radius)
         /* 1st octant */
         if( ( (x_cen + y0) <= 127 ) && ( ( y_cen - x0 ) >= 0  )  )
         {
-            ssd1306_drawPixel(x_cen + y0, y_cen - x0);
+            ssd1306_ram_pixel(x_cen + y0, y_cen - x0, TRUE);
         }
 
         /* 2nd octant */
         if( ( (x_cen + x0) <= 127 ) && ( ( y_cen - y0 ) >= 0  )  )
         {
-            ssd1306_drawPixel(x_cen + x0, y_cen - y0);
+            ssd1306_ram_pixel(x_cen + x0, y_cen - y0, TRUE);
         }
         
         /* 3rd octant */
         if( ( (x_cen - x0) >= 0 ) && ( ( y_cen - y0 ) >= 0  )  )
         {
-            ssd1306_drawPixel(x_cen - x0, y_cen - y0);
+            ssd1306_ram_pixel(x_cen - x0, y_cen - y0, TRUE);
         }
 
         /* 4th octant */
         if( ( (x_cen - y0) >= 0 ) && ( ( y_cen - x0 ) >= 0  )  )
         {
-            ssd1306_drawPixel(x_cen - y0, y_cen - x0);
+            ssd1306_ram_pixel(x_cen - y0, y_cen - x0, TRUE);
         }
 
         /* 5th octant */
         if( ( (x_cen - y0) >= 0 ) && ( ( y_cen + x0 ) <= 63  )  )
         {
-            ssd1306_drawPixel(x_cen - y0, y_cen + x0);
+            ssd1306_ram_pixel(x_cen - y0, y_cen + x0, TRUE);
         }
 
         /* 6th octant */
         if( ( (x_cen - x0) >= 0 ) && ( ( y_cen + y0 ) <= 63  )  )
         {
-            ssd1306_drawPixel(x_cen - x0, y_cen + y0);
+            ssd1306_ram_pixel(x_cen - x0, y_cen + y0, TRUE);
         }
 
         /* 7th octant */
         if( ( (x_cen + x0) <= 127 ) && ( ( y_cen + y0 ) <= 63  )  )
         {
-            ssd1306_drawPixel(x_cen + x0, y_cen + y0);
+            ssd1306_ram_pixel(x_cen + x0, y_cen + y0, TRUE);
         }
         
         /* 8th octant */
         if( ( (x_cen + y0) <= 127 ) && ( ( y_cen + x0 ) <= 63  )  )
         {
-            ssd1306_drawPixel(x_cen + y0, y_cen + x0);
+            ssd1306_ram_pixel(x_cen + y0, y_cen + x0, TRUE);
         }
     }
 
@@ -352,20 +637,21 @@ void ssd1306_drawCircle(uint8_t x_cen, uint8_t y_cen, uint8_t radius)
 
     if( (x_cen + radius) <= display_width )
     {
-        ssd1306_drawPixel(x_cen + radius, y_cen);
+        ssd1306_ram_pixel(x_cen + radius, y_cen, TRUE);
     }
     if( (x_cen - radius) >= 0 )
     {
-        ssd1306_drawPixel(x_cen - radius, y_cen);
+        ssd1306_ram_pixel(x_cen - radius, y_cen, TRUE);
     }
     if( (y_cen + radius) <= display_height )
     {
-        ssd1306_drawPixel(x_cen, y_cen + radius);
+        ssd1306_ram_pixel(x_cen, y_cen + radius, TRUE);
     }
     if( (y_cen - radius) >= 0 )
     {
-        ssd1306_drawPixel(x_cen, y_cen - radius);
+        ssd1306_ram_pixel(x_cen, y_cen - radius, TRUE);
     }
+    ssd1306_render_end();
 }
 
 
@@ -377,36 +663,71 @@ void ssd1306_drawCircle(uint8_t x_cen, uint8_t y_cen, uint8_t radius)
  */
 void ssd1306_displayMoveCursor(uint8_t col, SSD1306_PageNum_t row)
 {
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, 0x00);
-    i2c_write(SSD1306_I2Cx, 0x21);
-    i2c_write(SSD1306_I2Cx, col);
-    i2c_write(SSD1306_I2Cx, 0x7F);
-    i2c_write(SSD1306_I2Cx, 0x22);
-    i2c_write(SSD1306_I2Cx, row);
-    i2c_write(SSD1306_I2Cx, 0x07);
-    i2c_stop(SSD1306_I2Cx);
+    ssd1306_set_window(col, 0x7F, row, PAGE7);
+}
+
+
+/**
+ * @brief    Set the column and page window of the GDDRAM address pointer,
+ *           the pointer moves to (col_start, page_start) and wraps inside the window
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, PAGE0..PAGE7
+ * @param    page_end: last page, PAGE0..PAGE7
+ * @retval   none
+ */
+void ssd1306_displaySetWindow(uint8_t col_start, uint8_t col_end, SSD1306_PageNum_t page_start, SSD1306_PageNum_t page_end)
+{
+    ssd1306_set_window(col_start, col_end, page_start, page_end);
+}
+
+
+/**
+ * @brief    Write bytes straight to the display GDDRAM at the address pointer
+ *           in a single transaction, the framebuffer is left untouched
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @retval   none
+ */
+void ssd1306_displayWriteData(const uint8_t *data, uint16_t len)
+{
+    ssd1306_data_burst(data, len);
+    ssd1306_sync_lost();
+}
+
+
+/**
+ * @brief    Write bytes to a GDDRAM window, the window setup and the data
+ *           share one transaction when SSD1306_USE_CO_BIT is set
+ *           Note: * The framebuffer is left untouched.
+ *                 * The window setup is skipped when the bytes land at the
+ *                   address pointer of a single page without wrapping, later
+ *                   writes must not rely on the window wrapping.
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, PAGE0..PAGE7
+ * @param    page_end: last page, PAGE0..PAGE7
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @retval   none
+ */
+void ssd1306_displayWriteWindow(uint8_t col_start, uint8_t col_end, SSD1306_PageNum_t page_start,
+                                SSD1306_PageNum_t page_end, const uint8_t *data, uint16_t len)
+{
+    ssd1306_window_burst(col_start, col_end, page_start, page_end, data, len);
+    ssd1306_sync_lost();
 }
 
 
 /**
- * @brief    Clears the entire display
+ * @brief    Clears the entire display and the GDDRAM
  * @param    none
  * @retval   none
  */
 void ssd1306_displayClear(void)
 {
-    ssd1306_displayMoveCursor(0, 0);
-
-    for(uint16_t i = 0; i < 1024; i++)
-    {
-        i2c_start(SSD1306_I2Cx);
-        i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-        i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
-        i2c_write(SSD1306_I2Cx, 0x00);
-    }
-    i2c_stop(SSD1306_I2Cx);
+    ssd1306_ramClear();
+    ssd1306_ramUpdateFull();
 }
 
 
@@ -417,7 +738,20 @@ void ssd1306_displayClear(void)
  */
 void ssd1306_displayContrast(uint8_t val)
 {
-    ssd1306_cmd_double(0x81, val);
+    ssd1306_reg_double(&reg_contrast, 0x81, val);
+}
+
+
+/**
+ * @brief    Set the GDDRAM row shown on the top line of the display
+ *           The display wraps around, so this scrolls the whole screen
+ *           vertically without rewriting the GDDRAM.
+ * @param    line: row from 0..63, reset value is 0
+ * @retval   none
+ */
+void ssd1306_displayStartLine(uint8_t line)
+{
+    ssd1306_reg_single(&reg_start_line, 0x40 | (line & 0x3F));
 }
 
 
@@ -431,11 +765,11 @@ void ssd1306_displayInvert(SSD1306_FunctionalState_t state)
 {
     if(state)
     {
-        ssd1306_cmd_single(0xA7);
+        ssd1306_reg_single(&reg_invert, 0xA7);
     }
     else
     {
-        ssd1306_cmd_single(0xA6);
+        ssd1306_reg_single(&reg_invert, 0xA6);
     }
 }
 
@@ -449,11 +783,11 @@ void ssd1306_displayOn(SSD1306_FunctionalState_t state)
 {
     if(state)
     {
-        ssd1306_cmd_single(0xAF);
+        ssd1306_reg_single(&reg_on, 0xAF);
     }
     else
     {
-        ssd1306_cmd_single(0xAE);
+        ssd1306_reg_single(&reg_on, 0xAE);
     }
 }
 
@@ -472,17 +806,14 @@ void ssd1306_displayOn(SSD1306_FunctionalState_t state)
 void ssd1306_displayScrollHorizontal(SSD1306_ScrollDir_t dir, SSD1306_FrameFreq_t freq,
                            SSD1306_PageNum_t page_start, SSD1306_PageNum_t page_end)
 {
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, CMD_CTRL_BYTE);
-    i2c_write(SSD1306_I2Cx, 0x26 | dir);
-    i2c_write(SSD1306_I2Cx, 0x00);
-    i2c_write(SSD1306_I2Cx, page_start);
-    i2c_write(SSD1306_I2Cx, freq);
-    i2c_write(SSD1306_I2Cx, page_end);
-    i2c_write(SSD1306_I2Cx, 0x00);
-    i2c_write(SSD1306_I2Cx, 0xFF);
-    i2c_stop(SSD1306_I2Cx);
+    const uint8_t setup[] = { 0x26 | dir, 0x00, page_start, freq, page_end, 0x00, 0xFF };
+
+    if( !ssd1306_reg_scroll_setup(setup, sizeof(setup)) )
+    {
+        return;
+    }
+
+    ssd1306_cmd_list(setup, sizeof(setup));
 }
 
 
@@ -524,16 +855,14 @@ void ssd1306_displayScrollVertical(SSD1306_ScrollDir_t dir, SSD1306_FrameFreq_t
 void ssd1306_displayScrollDiagonal(SSD1306_ScrollDir_t dir, SSD1306_FrameFreq_t freq,
                                    SSD1306_PageNum_t page_start, SSD1306_PageNum_t page_end, uint8_t offset)
 {
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, CMD_CTRL_BYTE);
-    i2c_write(SSD1306_I2Cx, 0x28 | dir);
-    i2c_write(SSD1306_I2Cx, 0x00);
-    i2c_write(SSD1306_I2Cx, page_start);
-    i2c_write(SSD1306_I2Cx, freq);
-    i2c_write(SSD1306_I2Cx, page_end);
-    i2c_write(SSD1306_I2Cx, offset);
-    i2c_stop(SSD1306_I2Cx);
+    const uint8_t setup[] = { 0x28 | dir, 0x00, page_start, freq, page_end, offset };
+
+    if( !ssd1306_reg_scroll_setup(setup, sizeof(setup)) )
+    {
+        return;
+    }
+
+    ssd1306_cmd_list(setup, sizeof(setup));
 }
 
 
@@ -547,13 +876,14 @@ void ssd1306_displayScrollDiagonal(SSD1306_ScrollDir_t dir, SSD1306_FrameFreq_t
  */
 void ssd1306_displaySetVerticalScrollArea(uint8_t fixed)
 {
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, CMD_CTRL_BYTE);
-    i2c_write(SSD1306_I2Cx, 0xA3);
-    i2c_write(SSD1306_I2Cx, fixed);
-    i2c_write(SSD1306_I2Cx, 64 - fixed);
-    i2c_stop(SSD1306_I2Cx);
+    if( regs_valid && (reg_scroll_area == fixed) )
+    {
+        return;
+    }
+    reg_scroll_area = fixed;
+
+    const uint8_t cmd[] = { 0xA3, fixed, 64 - fixed };
+    ssd1306_cmd_list(cmd, sizeof(cmd));
 }
 
 
@@ -566,11 +896,13 @@ void ssd1306_displayScrollState(SSD1306_FunctionalState_t state)
 {
     if(state)
     {
-        ssd1306_cmd_single(0x2F);
+        ssd1306_reg_single(&reg_scroll, 0x2F);
     }
-    else
+    else if( !regs_valid || (reg_scroll != 0x2E) )
     {
-        ssd1306_cmd_single(0x2E);
+        ssd1306_reg_single(&reg_scroll, 0x2E);
+        /* GDDRAM content must be rewritten after a scroll is deactivated */
+        ssd1306_sync_lost();
     }
 }
 
@@ -584,7 +916,15 @@ void ssd1306_displayScrollState(SSD1306_FunctionalState_t state)
  */
 void ssd1306_displayAddrMode(SSD1306_AddrMode_t mode)
 {
-    ssd1306_cmd_double(0x20, mode);
+    if( regs_valid && (reg_addr_mode == mode) )
+    {
+        return;
+    }
+    ssd1306_reg_double(&reg_addr_mode, 0x20, mode);
+
+    /* Window wraparound is only modelled for horizontal addressing */
+    addr_horizontal = (mode == HORIZONTAL_MODE);
+    addr_valid = 0;
 }
 
 
@@ -599,233 +939,1380 @@ void ssd1306_displayFlip(SSD1306_Orientation_t orientation, FunctionalState stat
     {
         if(state)
         {
-            ssd1306_cmd_single(0xA0);
+            ssd1306_reg_single(&reg_seg_remap, 0xA0);
         }
         else
         {
-            ssd1306_cmd_single(0xA1);
+            ssd1306_reg_single(&reg_seg_remap, 0xA1);
         }
     }
     else
     {
         if(state)
         {
-            ssd1306_cmd_single(0XC0);
+            ssd1306_reg_single(&reg_com_scan, 0xC0);
         }
         else
         {
-            ssd1306_cmd_single(0xC8);
+            ssd1306_reg_single(&reg_com_scan, 0xC8);
         }
     }
 }
 
 
 /**
- * @brief    Update the entire GDDRAM
+ * @brief    Send the initialization sequence again followed by every cached
+ *           setting that differs from it, in one command transaction, and
+ *           repaint the whole display on the next flush
+ *           Use after the panel lost its state, e.g. a reset or brown-out of
+ *           the display alone, or after ssd1306_busDropped() reported a
+ *           dropped call, which it clears. Charge pump, timing and panel layout are those
+ *           of ssd1306_init(), the rest as last set through the
+ *           ssd1306_display* functions.
  * @param    none
  * @retval   none
  */
-void ssd1306_ramUpdateFull(void)
+void ssd1306_resync(void)
 {
-    for(uint16_t i = 0; i < 1024; i++)
+    uint8_t cmd[sizeof(ssd1306_init_seq) + 9 + sizeof(reg_scroll_setup) + 3];
+    uint8_t len = 0;
+
+    bus_dropped = 0;
+
+    /* Leaves the display off with the settings ssd1306_init() starts from */
+    for(; len < sizeof(ssd1306_init_seq); len++)
     {
-        i2c_start(SSD1306_I2Cx);
-        i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-        i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
-        i2c_write(SSD1306_I2Cx,  *p_ram++ );
+        cmd[len] = ssd1306_init_seq[len];
+    }
+
+    if( reg_addr_mode != HORIZONTAL_MODE )
+    {
+        cmd[len++] = 0x20;
+        cmd[len++] = reg_addr_mode;
+    }
+    if( reg_seg_remap != 0xA1 )
+    {
+        cmd[len++] = reg_seg_remap;
+    }
+    if( reg_com_scan != 0xC8 )
+    {
+        cmd[len++] = reg_com_scan;
+    }
+    if( reg_start_line != 0x40 )
+    {
+        cmd[len++] = reg_start_line;
+    }
+    if( reg_contrast != 0x80 )
+    {
+        cmd[len++] = 0x81;
+        cmd[len++] = reg_contrast;
+    }
+    if( reg_invert != 0xA6 )
+    {
+        cmd[len++] = reg_invert;
+    }
+
+    if( reg_scroll_setup_len )
+    {
+        cmd[len++] = 0xA3;
+        cmd[len++] = reg_scroll_area;
+        cmd[len++] = 64 - reg_scroll_area;
+
+        for(uint8_t i = 0; i < reg_scroll_setup_len; i++)
+        {
+            cmd[len++] = reg_scroll_setup[i];
+        }
+    }
+
+    /* Scrolling is only started once the GDDRAM was repainted */
+    reg_scroll = 0x2E;
+    if( reg_on != 0xAE )
+    {
+        cmd[len++] = reg_on;
+    }
+
+    ssd1306_cmd_list(cmd, len);
+    regs_valid = 1;
+
+    addr_valid = 0;
+    ssd1306_sync_lost();
+    for(uint8_t page = 0; page < 8; page++)
+    {
+        ssd1306_mark_dirty(page, 0, SSD1306_WIDTH - 1);
     }
-    i2c_stop(SSD1306_I2Cx);
 }
 
 
 /**
- * @brief    Update a byte of the GDDRAM
- * @param    byte_pos: address of the byte to update. value range 0..1023
- * @param    byte_val: value to be put in the byte
- *           Note: The current value stored in the GDDRAM before a call to this
- *                 function will be retain.
+ * @brief    Start collecting commands, the ssd1306_display* functions add their
+ *           command bytes to a batch instead of sending each in a transaction
+ *           Calls can be nested, the batch goes out at the outermost
+ *           ssd1306_cmdEnd(). It is sent early when it fills up or before any
+ *           GDDRAM data so the order on the bus is kept.
+ * @param    none
  * @retval   none
  */
-void ssd1306_ramUpdateByte(uint16_t byte_pos, uint8_t byte_val)
+void ssd1306_cmdBegin(void)
 {
-    uint8_t y_pos = byte_pos / 128;
-    uint8_t x_pos = byte_pos - (128 * y_pos);
-    ssd1306_displayMoveCursor(x_pos, y_pos);
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
-    i2c_write(SSD1306_I2Cx,  *(p_ram + byte_pos) |= byte_val );
-    i2c_stop(SSD1306_I2Cx);
+    cmd_batch_depth++;
 }
 
 
 /**
- * @brief    Write a byte to the GDDRAM
- * @param    byte_pos: address of the byte to update. value range 0..1023
- * @param    byte_val: value to be put in the byte
- *           Note: * The current value stored in the GDDRAM before a call to this
- *                   function will be retain.
- *                 * This will only write a value the GDDRAM, to display the
- *                   result ssd1306_ramUpdateFull() function must be called.
+ * @brief    Send the commands collected since ssd1306_cmdBegin() after a
+ *           single [CMD_CTRL_BYTE] in one transaction
+ * @param    none
  * @retval   none
  */
-void ssd1306_ramWrite(uint16_t byte_pos, uint8_t byte_val)
+void ssd1306_cmdEnd(void)
 {
-    *(p_ram + byte_pos) |= byte_val;
+    if( cmd_batch_depth && !(--cmd_batch_depth) )
+    {
+        ssd1306_cmd_batch_send();
+    }
 }
 
 
 /**
- * @brief    Clears the entire GDDRAM
+ * @brief    Update the entire GDDRAM
  * @param    none
- *           Note: This will only clear the GDDRAM, to display the result 
- *                 ssd1306_ramUpdateFull() function must be called.
  * @retval   none
  */
-void ssd1306_ramClear(void)
+void ssd1306_ramUpdateFull(void)
 {
-    ssd1306_displayMoveCursor(0,0);
-    for(uint16_t i = 0; i < 1024; i++)
-    {
-        *p_ram++ = 0x00;
-    }
+    ssd1306_displayMoveCursor(0, 0);
+    ssd1306_data_burst(p_ram, 1024);
+    ssd1306_mark_clean();
+    ssd1306_sync_frame(p_ram);
 }
 
 
 /**
- * @brief    Issue a double byte command to the display
- *           see the display datasheet for more information
- * @param    cmd: command byte
+ * @brief    Update only the GDDRAM area that changed since the last update
+ *           FLUSH_DIRTY: each page that was written through the RAM-only functions
+ *           is sent as its own column window (0x21/0x22) followed by a burst of
+ *           the touched bytes.
+ *           FLUSH_SHADOW: each page is compared with the copy of the display and
+ *           only the changed runs of bytes are sent.
+ *           FLUSH_CRC: only the 16 column blocks whose signature changed are sent.
+ *           Note: The cursor window is left narrowed to the last run sent,
+ *                 call ssd1306_displayMoveCursor() before ssd1306_drawChar().
+ * @param    none
  * @retval   none
  */
-static void ssd1306_cmd_single(uint8_t cmd)
+void ssd1306_flush(void)
 {
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, 0x00);
-    i2c_write(SSD1306_I2Cx, cmd);
-    i2c_stop(SSD1306_I2Cx);
+    uint16_t sent = 0;
+
+#if (SSD1306_USE_SHADOW)
+    if( flush_mode == FLUSH_SHADOW )
+    {
+        sent = ssd1306_flush_shadow();
+    }
+    else
+#endif
+#if (SSD1306_USE_CRC)
+    if( flush_mode == FLUSH_CRC )
+    {
+        sent = ssd1306_flush_crc();
+    }
+    else
+#endif
+    {
+        for(uint8_t page = 0; page < 8; page++)
+        {
+            if( dirty_start[page] <= dirty_end[page] )
+            {
+                sent += ssd1306_send_run(page, dirty_start[page], dirty_end[page]);
+            }
+        }
+    }
+    ssd1306_mark_clean();
+
+    ssd1306_stats.flushes++;
+    ssd1306_stats.last_bytes = sent;
+    ssd1306_stats.last_saved = (sent < SSD1306_FRAME_COST) ? (SSD1306_FRAME_COST - sent) : 0;
+    ssd1306_stats.total_saved += ssd1306_stats.last_saved;
 }
 
 
 /**
- * @brief    Issue a double byte command to the display
- *           see the display datasheet for more information
- * @param    cmd: command byte
- * @param    val: command value 
+ * @brief    Select how ssd1306_flush() finds the bytes to send
+ * @param    mode: FLUSH_DIRTY (default), FLUSH_SHADOW or FLUSH_CRC. FLUSH_SHADOW
+ *                 requires SSD1306_USE_SHADOW, FLUSH_CRC requires SSD1306_USE_CRC,
+ *                 they are ignored otherwise
  * @retval   none
  */
-static void ssd1306_cmd_double(uint8_t cmd, uint8_t val)
-{    
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, 0x00);
-    i2c_write(SSD1306_I2Cx, cmd);
-    i2c_write(SSD1306_I2Cx, val);
-    i2c_stop(SSD1306_I2Cx);
+void ssd1306_setFlushMode(SSD1306_FlushMode_t mode)
+{
+#if (!SSD1306_USE_SHADOW)
+    if( mode == FLUSH_SHADOW )
+    {
+        return;
+    }
+#endif
+#if (!SSD1306_USE_CRC)
+    if( mode == FLUSH_CRC )
+    {
+        return;
+    }
+#endif
+    flush_mode = mode;
 }
 
 
 /**
- * @brief    Executes display's initialization sequence
- * @param    none
+ * @brief    Read the flush statistics
+ * @param    stats: pointer to SSD1306_Stats_t type structure to fill
  * @retval   none
  */
-void ssd1306_init(void)
+void ssd1306_getStats(SSD1306_Stats_t *stats)
 {
-    for(uint8_t i = 0; i < 254; i++);
+    *stats = ssd1306_stats;
+}
 
-    i2c_start(SSD1306_I2Cx);
-    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
-    i2c_write(SSD1306_I2Cx, CMD_CTRL_BYTE);
 
-    /* Entire Display OFF */
-    i2c_write(SSD1306_I2Cx, 0xAE);
+/**
+ * @brief    Select when the drawing functions reach the display
+ * @param    mode: RENDER_IMMEDIATE (default), every drawing function ends with
+ *                 ssd1306_flush() so the result shows at once, together with
+ *                 bytes left pending by ssd1306_ramWrite*().
+ *                 RENDER_DEFERRED, drawing functions only modify the GDDRAM,
+ *                 call ssd1306_flush() or ssd1306_present() to show the result.
+ * @retval   none
+ */
+void ssd1306_setRenderMode(SSD1306_RenderMode_t mode)
+{
+    render_mode = mode;
+}
+
+
+/**
+ * @brief    Read the current render mode
+ * @param    none
+ * @retval   RENDER_IMMEDIATE or RENDER_DEFERRED
+ */
+SSD1306_RenderMode_t ssd1306_getRenderMode(void)
+{
+    return render_mode;
+}
+
+
+/**
+ * @brief    Update the entire GDDRAM in the background
+ *           The cursor reset and the frame are queued as two transactions,
+ *           the frame is streamed with DMA when it was enabled in the
+ *           I2C_Init_t passed to i2c_init().
+ *           Note: Do not modify the GDDRAM until the transfer completes,
+ *                 polled display functions wait for it to complete.
+ * @param    callback: function called when the frame is on the display, can be 0
+ * @retval   none
+ */
+void ssd1306_flushAsync(SSD1306_Callback_t callback)
+{
+    ssd1306_queue_frame(p_ram, callback);
+    ssd1306_mark_clean();
+    ssd1306_sync_frame(p_ram);
+}
+
+
+/**
+ * @brief    Queue a command transaction, [CMD_CTRL_BYTE] [cmd 0] .. [cmd N-1]
+ *           Returns immediately unless all I2C_QUEUE_SIZE descriptors are in use,
+ *           then it waits for one to be freed.
+ *           Note: Lists longer than I2C_XFER_INLINE must stay valid until sent.
+ * @param    cmd: pointer to array of command bytes
+ * @param    len: number of command bytes
+ * @retval   none
+ */
+void ssd1306_queueCmd(const uint8_t *cmd, uint8_t len)
+{
+    ssd1306_cmd_batch_send();
+    while( !i2c_enqueue(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W, CMD_CTRL_BYTE, len, cmd, 0) );
+    addr_valid = 0;
+}
+
+
+/**
+ * @brief    Queue a GDDRAM data transaction, [DATA_CTRL_BYTE] [data 0] .. [data N-1]
+ *           Returns immediately unless all I2C_QUEUE_SIZE descriptors are in use,
+ *           then it waits for one to be freed.
+ *           Note: Data longer than I2C_XFER_INLINE must stay valid until callback.
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @param    callback: function called when the data was sent, can be 0
+ * @retval   none
+ */
+void ssd1306_queueData(const uint8_t *data, uint16_t len, SSD1306_Callback_t callback)
+{
+    ssd1306_cmd_batch_send();
+    while( !i2c_enqueue(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W, DATA_CTRL_BYTE, len, data, callback) );
+    addr_valid = 0;
+}
+
+
+/**
+ * @brief    Show the frame drawn in the GDDRAM
+ *           With SSD1306_DOUBLE_BUFFER the drawing buffer becomes the front
+ *           buffer and is streamed in the background, drawing continues in
+ *           the other buffer which starts as a copy of the presented frame.
+ *           Only waits if the previous frame is still being sent.
+ *           Without it this is the same as ssd1306_ramUpdateFull().
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_present(void)
+{
+#if (SSD1306_DOUBLE_BUFFER)
+    /* Previous frame is still streaming out of the front buffer */
+    while( ssd1306_isBusy() );
+
+    uint8_t *tmp = p_front;
+    p_front = p_ram;
+    p_ram = tmp;
+
+    ssd1306_queue_frame(p_front, 0);
+    ssd1306_mark_clean();
+    ssd1306_sync_frame(p_front);
+
+    /* Both buffers are only read from here on, copy word-wise so
+       drawing continues on top of the presented frame */
+    const uint32_t *src = (const uint32_t *)p_front;
+    uint32_t *dst = (uint32_t *)p_ram;
+    for(uint16_t i = 0; i < (1024 / 4); i++)
+    {
+        dst[i] = src[i];
+    }
+#else
+    ssd1306_ramUpdateFull();
+#endif
+}
+
+
+/**
+ * @brief    Check if a background update is still in progress
+ *           Polling it also moves the update on: a queued transaction that
+ *           waits for the previous stop condition is started from here, see
+ *           i2c_busy().
+ * @param    none
+ * @retval   1 if busy, 0 if idle
+ */
+uint8_t ssd1306_isBusy(void)
+{
+    return i2c_busy(SSD1306_I2Cx);
+}
+
+
+/**
+ * @brief    Check if the last background update was aborted by a bus error,
+ *           the display then shows an incomplete frame
+ *           Valid inside its callback and once ssd1306_isBusy() returned 0.
+ * @param    none
+ * @retval   1 if it failed, 0 if it was sent
+ */
+uint8_t ssd1306_txError(void)
+{
+    return i2c_txError(SSD1306_I2Cx);
+}
+
+
+/**
+ * @brief    Check if a display call was dropped because a background transfer
+ *           kept the bus for longer than SSD1306_CLAIM_TIMEOUT_US
+ *           The display then misses what that call sent, call ssd1306_resync()
+ *           and flush once ssd1306_isBusy() returned 0.
+ * @param    none
+ * @retval   1 if a call was dropped since the last ssd1306_resync(), 0 if not
+ */
+uint8_t ssd1306_busDropped(void)
+{
+    return bus_dropped;
+}
+
+
+/**
+ * @brief    Update a byte of the GDDRAM
+ * @param    byte_pos: address of the byte to update. value range 0..1023
+ * @param    byte_val: value to be put in the byte
+ *           Note: The current value stored in the GDDRAM before a call to this
+ *                 function will be retain.
+ * @retval   none
+ */
+void ssd1306_ramUpdateByte(uint16_t byte_pos, uint8_t byte_val)
+{
+    uint8_t y_pos = byte_pos / 128;
+    uint8_t x_pos = byte_pos - (128 * y_pos);
+
+    /* Sequential bytes find the pointer already in place */
+    if( !ssd1306_addr_ready(x_pos, y_pos, 1) )
+    {
+        ssd1306_displayMoveCursor(x_pos, y_pos);
+    }
+    *(p_ram + byte_pos) |= byte_val;
+
+    if( ssd1306_i2c_start() )
+    {
+        i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
+        i2c_write(SSD1306_I2Cx, *(p_ram + byte_pos));
+        ssd1306_i2c_stop();
+    }
+    ssd1306_addr_advance(1);
+    ssd1306_sync_byte(byte_pos);
+}
+
+
+/**
+ * @brief    Write a byte to the GDDRAM
+ * @param    byte_pos: address of the byte to update. value range 0..1023
+ * @param    byte_val: value to be put in the byte
+ *           Note: * The current value stored in the GDDRAM before a call to this
+ *                   function will be retain.
+ *                 * This will only write a value the GDDRAM, to display the
+ *                   result call ssd1306_flush() or ssd1306_ramUpdateFull().
+ *                   In RENDER_IMMEDIATE the next drawing call flushes it too.
+ * @retval   none
+ */
+void ssd1306_ramWrite(uint16_t byte_pos, uint8_t byte_val)
+{
+    *(p_ram + byte_pos) |= byte_val;
+    ssd1306_mark_dirty(byte_pos / 128, byte_pos % 128, byte_pos % 128);
+}
+
 
+/**
+ * @brief    Overwrite a run of bytes of one GDDRAM page
+ *           Copies a word at a time when the source and destination line up.
+ *           Note: This will only write the GDDRAM, call ssd1306_flush() to
+ *                 display the result. In RENDER_IMMEDIATE the next drawing
+ *                 call flushes it too.
+ * @param    page: page to write, PAGE0..PAGE7
+ * @param    col: first column, bytes past column 127 are dropped
+ * @param    data: pointer to the bytes to copy
+ * @param    len: number of bytes to copy
+ * @retval   none
+ */
+void ssd1306_ramWriteRun(SSD1306_PageNum_t page, uint8_t col, const uint8_t *data, uint8_t len)
+{
+    if( col >= SSD1306_WIDTH )
+    {
+        return;
+    }
+    if( len > (SSD1306_WIDTH - col) )
+    {
+        len = SSD1306_WIDTH - col;
+    }
+    if( !len )
+    {
+        return;
+    }
 
-    /* Timing & Driving Scheme Setting */
+    uint8_t *dst = p_ram + (128 * page) + col;
+    uint8_t i = 0;
 
-    /* Set Display Clock Divide Ratio and Oscillator Frequency */
-    i2c_write(SSD1306_I2Cx, 0xD5);
-    /* Default Setting for Display Clock Divide Ratio and Oscillator Frequency that is recommended */
-    i2c_write(SSD1306_I2Cx, 0xF0);
+    /* Bytes up to the first word boundary, then words if the source agrees */
+    for(; (i < len) && ((uint32_t)(dst + i) & 3U); i++)
+    {
+        dst[i] = data[i];
+    }
+    if( !((uint32_t)(data + i) & 3U) )
+    {
+        for(; (i + 4) <= len; i += 4)
+        {
+            *(uint32_t *)(dst + i) = *(const uint32_t *)(data + i);
+        }
+    }
+    for(; i < len; i++)
+    {
+        dst[i] = data[i];
+    }
 
+    ssd1306_mark_dirty(page, col, col + len - 1);
+}
 
-    /* Set pre-charge period */
-    i2c_write(SSD1306_I2Cx, 0xD9);
-    /* Phase 1 period of 15 DCLK, Phase 2 period of 1 DCLK */
-    i2c_write(SSD1306_I2Cx, 0xF1);
 
+/**
+ * @brief    Clears the entire GDDRAM
+ * @param    none
+ *           Note: This will only clear the GDDRAM, to display the result 
+ *                 ssd1306_ramUpdateFull() function must be called.
+ * @retval   none
+ */
+void ssd1306_ramClear(void)
+{
+    for(uint16_t i = 0; i < 1024; i++)
+    {
+        *(p_ram + i) = 0x00;
+    }
 
-    /* Set Vcomh deselect level */
-    i2c_write(SSD1306_I2Cx, 0xDB);
-    /* Vcomh deselect level ~ 0.77 Vcc */
-    i2c_write(SSD1306_I2Cx, 0x20);
+    for(uint8_t page = 0; page < 8; page++)
+    {
+        ssd1306_mark_dirty(page, 0, SSD1306_WIDTH - 1);
+    }
+}
 
 
-    /* Charge Pump Setting*/
-    i2c_write(SSD1306_I2Cx, 0x8D);
-    /* Enable charge dump during display on */
-    i2c_write(SSD1306_I2Cx, 0x14);
+/**
+ * @brief    Issue a double byte command to the display
+ *           see the display datasheet for more information
+ * @param    cmd: command byte
+ * @retval   none
+ */
+static void ssd1306_cmd_single(uint8_t cmd)
+{
+    ssd1306_cmd_list(&cmd, 1);
+}
 
 
-    /* Addressing Setting */
+/**
+ * @brief    Issue a double byte command to the display
+ *           see the display datasheet for more information
+ * @param    cmd: command byte
+ * @param    val: command value 
+ * @retval   none
+ */
+static void ssd1306_cmd_double(uint8_t cmd, uint8_t val)
+{
+    const uint8_t list[] = { cmd, val };
+    ssd1306_cmd_list(list, sizeof(list));
+}
 
-    /* Set memory addressing mode */
-    i2c_write(SSD1306_I2Cx, 0x20);
-    i2c_write(SSD1306_I2Cx, 0x00);
 
+/**
+ * @brief    Issue a list of command bytes in one transaction
+ *           [S] [ADDR_W] [CMD_CTRL_BYTE] [cmd 0] .. [cmd N-1] [P]
+ *           Between ssd1306_cmdBegin() and ssd1306_cmdEnd() the bytes are
+ *           added to the batch instead.
+ * @param    cmd: pointer to command bytes
+ * @param    len: number of command bytes
+ * @retval   none
+ */
+static void ssd1306_cmd_list(const uint8_t *cmd, uint8_t len)
+{
+    if( cmd_batch_depth )
+    {
+        if( (cmd_batch_len + len) > SSD1306_CMD_BATCH_SIZE )
+        {
+            ssd1306_cmd_batch_send();
+        }
+        if( len <= SSD1306_CMD_BATCH_SIZE )
+        {
+            for(uint8_t i = 0; i < len; i++)
+            {
+                cmd_batch[cmd_batch_len++] = cmd[i];
+            }
+            return;
+        }
+    }
 
-    /* Hardware Configuration (Panel resolution & layout related) */
+    if( ssd1306_i2c_start() )
+    {
+        i2c_write(SSD1306_I2Cx, CMD_CTRL_BYTE);
+        i2c_write_burst(SSD1306_I2Cx, MASTER, len, cmd);
+        ssd1306_i2c_stop();
+    }
+}
 
-    /* Set Display Start Line */
-    i2c_write(SSD1306_I2Cx, 0x40);
-    // i2c_write(0x7F);
 
-    /* x axis */
-    /* Set Segment Re-map */
-    // i2c_write(0xA0);
-    i2c_write(SSD1306_I2Cx, 0xA1);
+/**
+ * @brief    Send the commands collected in the batch, if any
+ * @param    none
+ * @retval   none
+ */
+static void ssd1306_cmd_batch_send(void)
+{
+    uint8_t len = cmd_batch_len;
 
-    /* Set Multiplex Ratio */
-    i2c_write(SSD1306_I2Cx, 0xA8);
-    i2c_write(SSD1306_I2Cx, SSD1306_HEIGHT - 1); // 64 COM lines
+    if( !len )
+    {
+        return;
+    }
 
+    /* Emptied first, ssd1306_i2c_start() sends a pending batch */
+    cmd_batch_len = 0;
 
-    /* y axis */
-    /* Set COM Output scan direction */
-    // i2c_write(0xC0);    // COM0 - COM63
-    i2c_write(SSD1306_I2Cx, 0xC8); // COM63 - COM0
+    if( ssd1306_i2c_start() )
+    {
+        i2c_write(SSD1306_I2Cx, CMD_CTRL_BYTE);
+        i2c_write_burst(SSD1306_I2Cx, MASTER, len, cmd_batch);
+        ssd1306_i2c_stop();
+    }
+}
 
-    /* Set display offset */
-    i2c_write(SSD1306_I2Cx, 0xD3);
-    /* 0 offset */
-    i2c_write(SSD1306_I2Cx, 0x00);
 
-    /* Set com pins hardware configuration */
-    i2c_write(SSD1306_I2Cx, 0xDA);
-    /* Alternative com pin configuration, disable com left/right remap */
-    i2c_write(SSD1306_I2Cx, 0x12);
+/**
+ * @brief    Stream N bytes to the GDDRAM in a single transaction
+ *           [S] [ADDR_W] [DATA_CTRL_BYTE] [data 0] .. [data N-1] [P]
+ *           The control byte is sent once, the GDDRAM address pointer
+ *           auto-increments on every data byte.
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @retval   none
+ */
+static void ssd1306_data_burst(const uint8_t *data, uint16_t len)
+{
+    if( ssd1306_i2c_start() )
+    {
+        i2c_write(SSD1306_I2Cx, DATA_CTRL_BYTE);
+        i2c_write_burst(SSD1306_I2Cx, MASTER, len, data);
+        ssd1306_i2c_stop();
+    }
+    ssd1306_addr_advance(len);
+}
 
-    /* Set contrast control */
-    i2c_write(SSD1306_I2Cx, 0x81);
-    /* Set Contrast to 128 */
-    i2c_write(SSD1306_I2Cx, 0x80);
 
-    /* Entire display ON, resume to RAM content display */
-    i2c_write(SSD1306_I2Cx, 0xA4);
+/**
+ * @brief    Begin a transaction to the display
+ *           [S] [ADDR_W], waits up to SSD1306_CLAIM_TIMEOUT_US for a background
+ *           transfer to complete first and claims the bus. Pending batched
+ *           commands are sent before.
+ *           Note: When the wait times out nothing is sent, the caller skips the
+ *                 transaction and ssd1306_busDropped() reports it.
+ * @param    none
+ * @retval   1 if the transaction was begun, 0 if it was dropped
+ */
+static uint8_t ssd1306_i2c_start(void)
+{
+    /* Batched commands go first to keep the order of transactions */
+    ssd1306_cmd_batch_send();
 
-    /* Set Display in Normal Mode, 1 = ON, 0 = OFF */
-    i2c_write(SSD1306_I2Cx, 0xA6);
+    /* Bounded, called at or above the I2C interrupt priority the background
+       transfer would never end */
+    for(uint32_t waited = 0; !i2c_claim(SSD1306_I2Cx); waited++)
+    {
+        if( waited == SSD1306_CLAIM_TIMEOUT_US )
+        {
+            /* The display no longer shows what the driver state says */
+            bus_dropped = 1;
+            addr_valid = 0;
+            ssd1306_sync_lost();
+            return 0;
+        }
+        delay_us(1);
+    }
 
-    /* Deactivate scroll */
-    i2c_write(SSD1306_I2Cx, 0x2E);
+    i2c_start(SSD1306_I2Cx);
+    i2c_request(SSD1306_I2Cx, SSD1306_SLAVE_ADDR_W);
+    return 1;
+}
 
-    /* Display on in normal mode */
-    i2c_write(SSD1306_I2Cx, 0xAF);
 
+/**
+ * @brief    End a transaction begun with ssd1306_i2c_start()
+ *           [P], then releases the bus to the transactions queued meanwhile.
+ * @param    none
+ * @retval   none
+ */
+static void ssd1306_i2c_stop(void)
+{
     i2c_stop(SSD1306_I2Cx);
+    i2c_release(SSD1306_I2Cx);
+}
+
+
+/**
+ * @brief    Queue a full frame, cursor reset included
+ * @param    frame: pointer to the 1024 bytes to send
+ * @param    callback: function called when the frame was sent, can be 0
+ * @retval   none
+ */
+static void ssd1306_queue_frame(const uint8_t *frame, SSD1306_Callback_t callback)
+{
+    const uint8_t window[] = { 0x21, 0x00, 0x7F, 0x22, PAGE0, PAGE7 };
+
+    ssd1306_queueCmd(window, sizeof(window));
+    ssd1306_queueData(frame, 1024, callback);
+
+    /* A full window wraps back to its start, later transactions wait
+       for the queue to drain */
+    ssd1306_addr_window(0, 0x7F, PAGE0, PAGE7);
+}
+
+
+/**
+ * @brief    Set the column and page window of the GDDRAM address pointer,
+ *           the pointer moves to (col_start, page_start)
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, PAGE0..PAGE7
+ * @param    page_end: last page, PAGE0..PAGE7
+ * @retval   none
+ */
+static void ssd1306_set_window(uint8_t col_start, uint8_t col_end, uint8_t page_start, uint8_t page_end)
+{
+    if( addr_valid && (addr_col == col_start) && (addr_page == page_start) &&
+        (win_col_start == col_start) && (win_col_end == col_end) &&
+        (win_page_start == page_start) && (win_page_end == page_end) )
+    {
+        return;
+    }
+
+    const uint8_t cmd[] = { 0x21, col_start, col_end, 0x22, page_start, page_end };
+    ssd1306_cmd_list(cmd, sizeof(cmd));
+
+    ssd1306_addr_window(col_start, col_end, page_start, page_end);
+}
+
+
+/**
+ * @brief    Send a window setup followed by GDDRAM data
+ *           With SSD1306_USE_CO_BIT both go in one transaction:
+ *           [S] [ADDR_W] 0x80 0x21 0x80 c0 .. 0x80 p1 [DATA_CTRL_BYTE] [data] .. [P]
+ *           otherwise as two, ssd1306_set_window() then ssd1306_data_burst().
+ *           The window setup is skipped when a single page run lands at the
+ *           address pointer without wrapping.
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, 0..7
+ * @param    page_end: last page, 0..7
+ * @param    data: pointer to the bytes to send
+ * @param    len: number of bytes to send
+ * @retval   bytes on the wire
+ */
+static uint16_t ssd1306_window_burst(uint8_t col_start, uint8_t col_end, uint8_t page_start, uint8_t page_end,
+                                     const uint8_t *data, uint16_t len)
+{
+    if( (page_start == page_end) && ssd1306_addr_ready(col_start, page_start, len) )
+    {
+        ssd1306_data_burst(data, len);
+        return 2U + len;
+    }
+
+#if (SSD1306_USE_CO_BIT)
+    const uint8_t window[] = { 0x80, 0x21, 0x80, col_start, 0x80, col_end,
+                               0x80, 0x22, 0x80, page_start, 0x80, page_end, DATA_CTRL_BYTE };
+
+    if( ssd1306_i2c_start() )
+    {
+        i2c_write_burst(SSD1306_I2Cx, MASTER, sizeof(window), window);
+        i2c_write_burst(SSD1306_I2Cx, MASTER, len, data);
+        ssd1306_i2c_stop();
+    }
+
+    ssd1306_addr_window(col_start, col_end, page_start, page_end);
+    ssd1306_addr_advance(len);
+#else
+    ssd1306_set_window(col_start, col_end, page_start, page_end);
+    ssd1306_data_burst(data, len);
+#endif
+    return SSD1306_WINDOW_COST + len;
+}
+
+
+/**
+ * @brief    Send a single byte command unless the register already holds it
+ * @param    reg: pointer to the cached register
+ * @param    cmd: command byte
+ * @retval   none
+ */
+static void ssd1306_reg_single(uint8_t *reg, uint8_t cmd)
+{
+    if( regs_valid && (*reg == cmd) )
+    {
+        return;
+    }
+    ssd1306_cmd_single(cmd);
+    *reg = cmd;
+}
+
 
+/**
+ * @brief    Send a double byte command unless the register already holds val
+ * @param    reg: pointer to the cached register
+ * @param    cmd: command byte
+ * @param    val: command value
+ * @retval   none
+ */
+static void ssd1306_reg_double(uint8_t *reg, uint8_t cmd, uint8_t val)
+{
+    if( regs_valid && (*reg == val) )
+    {
+        return;
+    }
+    ssd1306_cmd_double(cmd, val);
+    *reg = val;
+}
+
+
+/**
+ * @brief    Record a scroll setup command
+ * @param    cmd: pointer to the command bytes
+ * @param    len: number of command bytes, up to 7
+ * @retval   1 if it differs from the last setup and must be sent, 0 if not
+ */
+static uint8_t ssd1306_reg_scroll_setup(const uint8_t *cmd, uint8_t len)
+{
+    uint8_t same = regs_valid && (reg_scroll_setup_len == len);
+
+    for(uint8_t i = 0; i < len; i++)
+    {
+        same = same && (reg_scroll_setup[i] == cmd[i]);
+        reg_scroll_setup[i] = cmd[i];
+    }
+    reg_scroll_setup_len = len;
+
+    return !same;
+}
+
+
+/**
+ * @brief    Record a window as programmed, the address pointer is at its start
+ * @param    col_start: first column, 0..127
+ * @param    col_end: last column, 0..127
+ * @param    page_start: first page, 0..7
+ * @param    page_end: last page, 0..7
+ * @retval   none
+ */
+static void ssd1306_addr_window(uint8_t col_start, uint8_t col_end, uint8_t page_start, uint8_t page_end)
+{
+    win_col_start = col_start;
+    win_col_end = col_end;
+    win_page_start = page_start;
+    win_page_end = page_end;
+    addr_col = col_start;
+    addr_page = page_start;
+    addr_valid = addr_horizontal && !bus_dropped;
+}
+
+
+/**
+ * @brief    Check if len bytes sent now land from (col, page) onwards on one
+ *           page, the address pointer is there and the window does not wrap
+ * @param    col: column of the first byte
+ * @param    page: page of the bytes
+ * @param    len: number of bytes
+ * @retval   1 if no window setup is needed, 0 if not
+ */
+static uint8_t ssd1306_addr_ready(uint8_t col, uint8_t page, uint16_t len)
+{
+    return addr_valid && (addr_col == col) && (addr_page == page) &&
+           ((col + len - 1) <= win_col_end);
+}
+
+
+/**
+ * @brief    Move the tracked address pointer past len data bytes
+ *           Horizontal addressing: the column wraps to the window start and
+ *           the page advances, the page wraps to the window start.
+ * @param    len: number of bytes written
+ * @retval   none
+ */
+static void ssd1306_addr_advance(uint16_t len)
+{
+    if( !addr_valid )
+    {
+        return;
+    }
+
+    uint16_t width = win_col_end - win_col_start + 1;
+    uint16_t size = width * (win_page_end - win_page_start + 1);
+    uint16_t pos = ((addr_page - win_page_start) * width) + (addr_col - win_col_start);
+
+    pos = (pos + (len % size)) % size;
+    addr_page = win_page_start + (pos / width);
+    addr_col = win_col_start + (pos % width);
+}
+
+
+/**
+ * @brief    Grow the dirty column range of a page
+ * @param    page: page number, 0..7
+ * @param    col_start: first touched column
+ * @param    col_end: last touched column
+ * @retval   none
+ */
+static void ssd1306_mark_dirty(uint8_t page, uint8_t col_start, uint8_t col_end)
+{
+    if( col_start < dirty_start[page] )
+    {
+        dirty_start[page] = col_start;
+    }
+    if( col_end > dirty_end[page] )
+    {
+        dirty_end[page] = col_end;
+    }
+}
+
+
+/**
+ * @brief    Mark the whole GDDRAM as being in sync with the display
+ * @param    none
+ * @retval   none
+ */
+static void ssd1306_mark_clean(void)
+{
+    for(uint8_t page = 0; page < 8; page++)
+    {
+        dirty_start[page] = SSD1306_WIDTH;
+        dirty_end[page] = 0;
+    }
+}
+
+
+/**
+ * @brief    Set or clear a pixel in the GDDRAM, out of bounds pixels are ignored
+ * @param    x_pos: x-coordinate of pixel
+ * @param    y_pos: y-coordinate of pixel
+ * @param    state: TRUE to set, FALSE to clear
+ * @retval   none
+ */
+static void ssd1306_ram_pixel(uint8_t x_pos, uint8_t y_pos, SSD1306_FunctionalState_t state)
+{
+    if( (x_pos >= SSD1306_WIDTH) || (y_pos >= SSD1306_HEIGHT) )
+    {
+        return;
+    }
+
+    uint16_t byte_pos = x_pos + (128 * ( y_pos / 8) );
+
+    if(state)
+    {
+        *(p_ram + byte_pos) |= (0x01 << (y_pos % 8) );
+    }
+    else
+    {
+        *(p_ram + byte_pos) &= ~(0x01 << (y_pos % 8) );
+    }
+    ssd1306_mark_dirty(y_pos / 8, x_pos, x_pos);
+}
+
+
+/**
+ * @brief    Apply the same mask to a run of bytes of one page
+ * @param    page: page number, 0..7
+ * @param    x_pos1: first column
+ * @param    x_pos2: last column, x_pos2 >= x_pos1
+ * @param    mask: rows of the page to set or clear
+ * @param    state: TRUE to set, FALSE to clear
+ * @retval   none
+ */
+static void ssd1306_span_h(uint8_t page, uint8_t x_pos1, uint8_t x_pos2, uint8_t mask, SSD1306_FunctionalState_t state)
+{
+    uint8_t *p = p_ram + (128 * page) + x_pos1;
+    uint8_t *p_end = p_ram + (128 * page) + x_pos2;
+
+    if( mask == 0xFF )
+    {
+        /* Whole bytes, no read-modify-write */
+        uint8_t val = (state) ? 0xFF : 0x00;
+        while( p <= p_end )
+        {
+            *p++ = val;
+        }
+    }
+    else if(state)
+    {
+        while( p <= p_end )
+        {
+            *p++ |= mask;
+        }
+    }
+    else
+    {
+        while( p <= p_end )
+        {
+            *p++ &= ~mask;
+        }
+    }
+    ssd1306_mark_dirty(page, x_pos1, x_pos2);
+}
+
+
+/**
+ * @brief    Set or clear a rectangle of the GDDRAM, one masked span per page
+ *           Coordinates are inclusive and must be within the display.
+ * @param    x_pos1: left column
+ * @param    y_pos1: top row
+ * @param    x_pos2: right column, x_pos2 >= x_pos1
+ * @param    y_pos2: bottom row, y_pos2 >= y_pos1
+ * @param    state: TRUE to set, FALSE to clear
+ * @retval   none
+ */
+static void ssd1306_span_fill(uint8_t x_pos1, uint8_t y_pos1, uint8_t x_pos2, uint8_t y_pos2, SSD1306_FunctionalState_t state)
+{
+    uint8_t page_start = y_pos1 / 8;
+    uint8_t page_end = y_pos2 / 8;
+
+    for(uint8_t page = page_start; page <= page_end; page++)
+    {
+        uint8_t mask = 0xFF;
+
+        if( page == page_start )
+        {
+            mask &= span_mask_start[y_pos1 % 8];
+        }
+        if( page == page_end )
+        {
+            mask &= span_mask_end[y_pos2 % 8];
+        }
+        ssd1306_span_h(page, x_pos1, x_pos2, mask, state);
+    }
+}
+
+
+/**
+ * @brief    Combine the masked bits of a bitmap byte into a GDDRAM byte
+ * @param    dst: pointer to the GDDRAM byte
+ * @param    src: bitmap bits, already aligned to the page
+ * @param    mask: rows of the page covered by the bitmap
+ * @param    rop: raster operation
+ * @retval   none
+ */
+static inline void ssd1306_rop_byte(uint8_t *dst, uint8_t src, uint8_t mask, SSD1306_Rop_t rop)
+{
+    src &= mask;
+
+    switch(rop)
+    {
+        case ROP_COPY:
+            *dst = (*dst & ~mask) | src;
+            break;
+        case ROP_OR:
+            *dst |= src;
+            break;
+        case ROP_AND:
+            *dst &= (src | ~mask);
+            break;
+        case ROP_XOR:
+            *dst ^= src;
+            break;
+        case ROP_ANDNOT:
+            *dst &= ~src;
+            break;
+    }
+}
+
+
+/**
+ * @brief    Show the result of a drawing function in RENDER_IMMEDIATE mode
+ * @param    none
+ * @retval   none
+ */
+static void ssd1306_render_end(void)
+{
+    if( render_mode == RENDER_IMMEDIATE )
+    {
+        ssd1306_flush();
+    }
+}
+
+
+/**
+ * @brief    Send a run of bytes of one page through a new column window
+ * @param    page: page number, 0..7
+ * @param    col_start: first column of the run
+ * @param    col_end: last column of the run
+ * @retval   bytes on the wire
+ */
+static uint16_t ssd1306_send_run(uint8_t page, uint8_t col_start, uint8_t col_end)
+{
+    uint16_t sent = ssd1306_send_span(page, col_start, col_end);
+
+#if (SSD1306_USE_CRC)
+    for(uint8_t block = col_start / 16; block <= col_end / 16; block++)
+    {
+        ssd1306_crc[(8 * page) + block] = ssd1306_crc_block(p_ram + (128 * page) + (16 * block));
+    }
+#endif
+
+    return sent;
+}
+
+
+/**
+ * @brief    Send a run of bytes of one page, the CRC signatures of its
+ *           blocks are left to the caller
+ * @param    page: page number, 0..7
+ * @param    col_start: first column of the run
+ * @param    col_end: last column of the run
+ * @retval   bytes on the wire
+ */
+static uint16_t ssd1306_send_span(uint8_t page, uint8_t col_start, uint8_t col_end)
+{
+    uint16_t byte_pos = (128 * page) + col_start;
+    uint8_t len = col_end - col_start + 1;
+
+    uint16_t sent = ssd1306_window_burst(col_start, col_end, page, page, p_ram + byte_pos, len);
+
+#if (SSD1306_USE_SHADOW)
+    for(uint8_t i = 0; i < len; i++)
+    {
+        ssd1306_shadow[byte_pos + i] = p_ram[byte_pos + i];
+    }
+#endif
+
+    return sent;
+}
+
+
+/**
+ * @brief    Record a full frame as being on the display
+ * @param    frame: the GDDRAM copy that was sent, p_ram or p_front
+ * @retval   none
+ */
+static void ssd1306_sync_frame(const uint8_t *frame)
+{
+    /* A dropped transaction left the display unknown until ssd1306_resync() */
+    if( bus_dropped )
+    {
+        ssd1306_sync_lost();
+        return;
+    }
+
+#if (SSD1306_USE_SHADOW)
+    for(uint16_t i = 0; i < 1024; i++)
+    {
+        ssd1306_shadow[i] = frame[i];
+    }
+    shadow_valid = 1;
+#endif
+#if (SSD1306_USE_CRC)
+    /* Both GDDRAM copies are word aligned */
+    for(uint8_t block = 0; block < 64; block++)
+    {
+        ssd1306_crc[block] = ssd1306_crc_block(frame + (16 * block));
+    }
+    crc_valid = 1;
+#endif
+    (void)frame;
+}
+
+
+/**
+ * @brief    Record a single GDDRAM byte as being on the display
+ * @param    byte_pos: address of the byte sent. value range 0..1023
+ * @retval   none
+ */
+static void ssd1306_sync_byte(uint16_t byte_pos)
+{
+#if (SSD1306_USE_SHADOW)
+    ssd1306_shadow[byte_pos] = p_ram[byte_pos];
+#endif
+#if (SSD1306_USE_CRC)
+    ssd1306_crc[byte_pos / 16] = ssd1306_crc_block(p_ram + (byte_pos & ~0x0FU));
+#endif
+    (void)byte_pos;
+}
+
+
+/**
+ * @brief    Forget what is on the display, the next FLUSH_SHADOW or
+ *           FLUSH_CRC sends a full frame
+ * @param    none
+ * @retval   none
+ */
+static void ssd1306_sync_lost(void)
+{
+#if (SSD1306_USE_SHADOW)
+    shadow_valid = 0;
+#endif
+#if (SSD1306_USE_CRC)
+    crc_valid = 0;
+#endif
+}
+
+
+#if (SSD1306_USE_SHADOW)
+/**
+ * @brief    Send the runs of bytes that differ from the copy of the display
+ *           Pages are compared a word at a time. Two runs are merged when
+ *           the unchanged gap between them costs fewer bytes on the wire
+ *           than opening a new window.
+ * @param    none
+ * @retval   bytes on the wire
+ */
+static uint16_t ssd1306_flush_shadow(void)
+{
+    uint16_t sent = 0;
+
+    if( !shadow_valid )
+    {
+        ssd1306_ramUpdateFull();
+        return SSD1306_FRAME_COST;
+    }
+
+    for(uint8_t page = 0; page < 8; page++)
+    {
+        const uint32_t *cur = (const uint32_t *)(p_ram + (128 * page));
+        const uint32_t *old = (const uint32_t *)(ssd1306_shadow + (128 * page));
+        int16_t run_start = -1;
+        int16_t run_end = -1;
+
+        for(uint8_t word = 0; word < 32; word++)
+        {
+            uint32_t diff = cur[word] ^ old[word];
+
+            if( !diff )
+            {
+                continue;
+            }
+
+            /* Little endian, the lowest column is the least significant byte */
+            int16_t first = (4 * word) + (__builtin_ctz(diff) / 8);
+            int16_t last = (4 * word) + ((31 - __builtin_clz(diff)) / 8);
+
+            if( (run_start >= 0) && ((first - run_end - 1) > (int16_t)SSD1306_WINDOW_COST) )
+            {
+                sent += ssd1306_send_run(page, run_start, run_end);
+                run_start = -1;
+            }
+            if( run_start < 0 )
+            {
+                run_start = first;
+            }
+            run_end = last;
+        }
+
+        if( run_start >= 0 )
+        {
+            sent += ssd1306_send_run(page, run_start, run_end);
+        }
+    }
+
+    return sent;
+}
+#endif
+
+
+#if (SSD1306_USE_CRC)
+/**
+ * @brief    Signature of a 16 byte block, CRC-32 (poly 0x04C11DB7) over four words
+ *           Uses the CRC calculation unit, or the same CRC in software when
+ *           SSD1306_SW_CRC is defined (e.g. host builds)
+ * @param    block: pointer to a word aligned 16 byte block
+ * @retval   signature
+ */
+static uint32_t ssd1306_crc_block(const uint8_t *block)
+{
+    const uint32_t *word = (const uint32_t *)block;
+
+#if defined(SSD1306_SW_CRC)
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        crc ^= word[i];
+        for(uint8_t bit = 0; bit < 32; bit++)
+        {
+            crc = (crc & 0x80000000UL) ? ((crc << 1) ^ 0x04C11DB7UL) : (crc << 1);
+        }
+    }
+    return crc;
+#else
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = word[0];
+    CRC->DR = word[1];
+    CRC->DR = word[2];
+    CRC->DR = word[3];
+    return CRC->DR;
+#endif
+}
+
+
+/**
+ * @brief    Send the 16 column blocks whose signature changed since they were sent,
+ *           neighbouring blocks go out as one run
+ * @param    none
+ * @retval   bytes on the wire
+ */
+static uint16_t ssd1306_flush_crc(void)
+{
+    uint16_t sent = 0;
+
+    if( !crc_valid )
+    {
+        ssd1306_ramUpdateFull();
+        return SSD1306_FRAME_COST;
+    }
+
+    for(uint8_t page = 0; page < 8; page++)
+    {
+        int8_t run_start = -1;
+
+        for(uint8_t block = 0; block <= 8; block++)
+        {
+            uint8_t changed = 0;
+
+            if( block < 8 )
+            {
+                uint32_t sig = ssd1306_crc_block(p_ram + (128 * page) + (16 * block));
+                changed = ( sig != ssd1306_crc[(8 * page) + block] );
+
+                /* The block is sent below, keep the signature just computed */
+                ssd1306_crc[(8 * page) + block] = sig;
+            }
+
+            if( changed && (run_start < 0) )
+            {
+                run_start = block;
+            }
+            else if( !changed && (run_start >= 0) )
+            {
+                /* A gap of one block costs more than a new window */
+                sent += ssd1306_send_span(page, 16 * run_start, (16 * block) - 1);
+                run_start = -1;
+            }
+        }
+    }
+
+    return sent;
+}
+#endif
+
+
+/**
+ * @brief    Executes display's initialization sequence
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_init(void)
+{
+    ssd1306_initSplash(0);
+}
+
+
+/**
+ * @brief    Executes display's initialization sequence with a bitmap as the
+ *           first frame. The commands go in one transaction and the GDDRAM is
+ *           written while the display is still off, it is only turned on
+ *           once the frame is complete.
+ * @param    bitmap: pointer to a 1024 byte bitmap, 0 for a blank display
+ * @retval   none
+ */
+void ssd1306_initSplash(const uint8_t *bitmap)
+{
+    delay_us(SSD1306_POWERUP_DELAY_US);
+
+#if (SSD1306_USE_CRC) && !defined(SSD1306_SW_CRC)
+    RCC->AHBENR |= RCC_AHBENR_CRCEN;
+#endif
+
+    ssd1306_cmd_list(ssd1306_init_seq, sizeof(ssd1306_init_seq));
+
+    /* The sequence ends with a full window in horizontal addressing mode */
+    addr_horizontal = 1;
+    ssd1306_addr_window(0, 0x7F, PAGE0, PAGE7);
+
+    /* Settings sent above, later calls only send what changes */
+    reg_contrast = 0x80;
+    reg_invert = 0xA6;
+    reg_on = 0xAE;
+    reg_addr_mode = HORIZONTAL_MODE;
+    reg_seg_remap = 0xA1;
+    reg_com_scan = 0xC8;
+    reg_start_line = 0x40;
+    reg_scroll = 0x2E;
+    reg_scroll_area = 0;
+    reg_scroll_setup_len = 0;
+    regs_valid = 1;
+
+    if( bitmap )
+    {
+        ssd1306_drawBitmap(bitmap);
+    }
+    else
+    {
+        ssd1306_displayClear();
+    }
 
-    ssd1306_displayClear();
+    ssd1306_displayOn(TRUE);
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_sprite.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Sprite layer on top of the SSD1306 framebuffer
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_sprite.h"
+
+
+static void ssd1306_sprite_draw(SSD1306_Sprite_t *sprite);
+static void ssd1306_sprite_erase(SSD1306_Sprite_t *sprite);
+static uint32_t ssd1306_sprite_column(const uint8_t *bitmap, uint8_t width, uint8_t height, uint8_t col);
+
+
+
+/**
+ * @brief    Initializes a SSD1306_Sprite_t type structure
+ *           image, mask and save_under are page-major, width * ((height + 7) / 8) bytes.
+ *           SPRITE_MASKED: pixels set in mask are opaque and take the image
+ *           value, image must not set pixels outside the mask. The background under the sprite is kept in
+ *           save_under and put back when the sprite moves or is hidden.
+ *           SPRITE_XOR: image is XORed onto the display, drawing it twice restores
+ *           the background so save_under is not used and can be 0.
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @param    image: pointer to the sprite bitmap
+ * @param    mask: pointer to the sprite mask, 0 to use image as its own mask
+ * @param    save_under: pointer to the background buffer, 0 in SPRITE_XOR mode
+ * @param    width: sprite width in pixels
+ * @param    height: sprite height in pixels, up to SSD1306_SPRITE_MAX_HEIGHT
+ * @param    mode: SPRITE_MASKED or SPRITE_XOR
+ * @retval   none
+ */
+void ssd1306_spriteInit(SSD1306_Sprite_t *sprite, const uint8_t *image, const uint8_t *mask,
+                        uint8_t *save_under, uint8_t width, uint8_t height, SSD1306_SpriteMode_t mode)
+{
+    sprite->image = image;
+    sprite->mask = (mask) ? mask : image;
+    sprite->save_under = save_under;
+    sprite->width = width;
+    sprite->height = (height > SSD1306_SPRITE_MAX_HEIGHT) ? SSD1306_SPRITE_MAX_HEIGHT : height;
+    sprite->x_pos = 0;
+    sprite->y_pos = 0;
+    sprite->mode = mode;
+    sprite->visible = 0;
+}
+
+
+/**
+ * @brief    Draw the sprite at a position, a visible sprite is moved there
+ *           Only the old and the new sprite area are marked dirty.
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @param    x_pos: x-coordinate of the sprite's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the sprite's upper left corner, can be negative
+ * @retval   none
+ */
+void ssd1306_spriteMove(SSD1306_Sprite_t *sprite, int16_t x_pos, int16_t y_pos)
+{
+    SSD1306_RenderMode_t mode = ssd1306_getRenderMode();
+
+    /* Erase and redraw reach the display in one flush */
+    ssd1306_setRenderMode(RENDER_DEFERRED);
+
+    if( sprite->visible )
+    {
+        ssd1306_sprite_erase(sprite);
+    }
+    sprite->x_pos = x_pos;
+    sprite->y_pos = y_pos;
+    ssd1306_sprite_draw(sprite);
+
+    ssd1306_setRenderMode(mode);
+    if( mode == RENDER_IMMEDIATE )
+    {
+        ssd1306_flush();
+    }
+}
+
+
+/**
+ * @brief    Remove the sprite and restore the background under it
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @retval   none
+ */
+void ssd1306_spriteHide(SSD1306_Sprite_t *sprite)
+{
+    if( sprite->visible )
+    {
+        ssd1306_sprite_erase(sprite);
+    }
+}
+
+
+/**
+ * @brief    Pixel-perfect collision test between two sprites, the masks
+ *           are compared at the sprites' current positions
+ * @param    sprite_a: pointer to SSD1306_Sprite_t type structure
+ * @param    sprite_b: pointer to SSD1306_Sprite_t type structure
+ * @retval   1 if any opaque pixels overlap, 0 if not
+ */
+uint8_t ssd1306_spriteCollide(const SSD1306_Sprite_t *sprite_a, const SSD1306_Sprite_t *sprite_b)
+{
+    int16_t x_start = (sprite_a->x_pos > sprite_b->x_pos) ? sprite_a->x_pos : sprite_b->x_pos;
+    int16_t x_end_a = sprite_a->x_pos + sprite_a->width;
+    int16_t x_end_b = sprite_b->x_pos + sprite_b->width;
+    int16_t x_end = (x_end_a < x_end_b) ? x_end_a : x_end_b;
+    int16_t dy = sprite_b->y_pos - sprite_a->y_pos;
+
+    /* Sprites are at most 32 rows tall, further apart they cannot touch */
+    if( (dy >= 32) || (dy <= -32) )
+    {
+        return 0;
+    }
+
+    for(int16_t x = x_start; x < x_end; x++)
+    {
+        uint32_t col_a = ssd1306_sprite_column(sprite_a->mask, sprite_a->width, sprite_a->height, x - sprite_a->x_pos);
+        uint32_t col_b = ssd1306_sprite_column(sprite_b->mask, sprite_b->width, sprite_b->height, x - sprite_b->x_pos);
+
+        /* Align both columns to the upper sprite, rows shifted out are past its height */
+        uint32_t hit = (dy >= 0) ? (col_a & (col_b << dy)) : ((col_a << -dy) & col_b);
+
+        if( hit )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief    Pixel-perfect collision test between a sprite and the background
+ *           The sprite's own pixels are excluded when it is visible.
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @retval   1 if any opaque pixel covers a set background pixel, 0 if not
+ */
+uint8_t ssd1306_spriteCollideRam(const SSD1306_Sprite_t *sprite)
+{
+    uint8_t column[SSD1306_SPRITE_MAX_HEIGHT / 8];
+
+    for(uint8_t col = 0; col < sprite->width; col++)
+    {
+        uint32_t mask = ssd1306_sprite_column(sprite->mask, sprite->width, sprite->height, col);
+        uint32_t background;
+
+        if( sprite->visible && (sprite->mode == SPRITE_MASKED) )
+        {
+            background = ssd1306_sprite_column(sprite->save_under, sprite->width, sprite->height, col);
+        }
+        else
+        {
+            ssd1306_ramRead(column, 1, sprite->height, sprite->x_pos + col, sprite->y_pos);
+            background = ssd1306_sprite_column(column, 1, sprite->height, 0);
+
+            if( sprite->visible )
+            {
+                /* SPRITE_XOR, undo the sprite's own pixels */
+                background ^= ssd1306_sprite_column(sprite->image, sprite->width, sprite->height, col);
+            }
+        }
+
+        if( mask & background )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief    Draw the sprite at its position, saving the background first
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @retval   none
+ */
+static void ssd1306_sprite_draw(SSD1306_Sprite_t *sprite)
+{
+    if( sprite->mode == SPRITE_XOR )
+    {
+        ssd1306_blit(sprite->image, sprite->width, sprite->height, sprite->x_pos, sprite->y_pos, ROP_XOR);
+    }
+    else
+    {
+        ssd1306_ramRead(sprite->save_under, sprite->width, sprite->height, sprite->x_pos, sprite->y_pos);
+        ssd1306_blit(sprite->mask, sprite->width, sprite->height, sprite->x_pos, sprite->y_pos, ROP_ANDNOT);
+        ssd1306_blit(sprite->image, sprite->width, sprite->height, sprite->x_pos, sprite->y_pos, ROP_OR);
+    }
+    sprite->visible = 1;
+}
+
+
+/**
+ * @brief    Remove the sprite from its position
+ * @param    sprite: pointer to SSD1306_Sprite_t type structure
+ * @retval   none
+ */
+static void ssd1306_sprite_erase(SSD1306_Sprite_t *sprite)
+{
+    if( sprite->mode == SPRITE_XOR )
+    {
+        ssd1306_blit(sprite->image, sprite->width, sprite->height, sprite->x_pos, sprite->y_pos, ROP_XOR);
+    }
+    else
+    {
+        ssd1306_blit(sprite->save_under, sprite->width, sprite->height, sprite->x_pos, sprite->y_pos, ROP_COPY);
+    }
+    sprite->visible = 0;
+}
+
+
+/**
+ * @brief    Gather one column of a page-major bitmap into a word, row 0 at bit 0
+ * @param    bitmap: pointer to bitmap
+ * @param    width: bitmap width in pixels
+ * @param    height: bitmap height in pixels, up to 32
+ * @param    col: column to gather
+ * @retval   column bits
+ */
+static uint32_t ssd1306_sprite_column(const uint8_t *bitmap, uint8_t width, uint8_t height, uint8_t col)
+{
+    uint32_t bits = 0;
+
+    for(uint8_t page = 0; page < ((height + 7) / 8); page++)
+    {
+        bits |= (uint32_t)bitmap[(width * page) + col] << (8 * page);
+    }
+
+    if( height < 32 )
+    {
+        bits &= (1UL << height) - 1;
+    }
+    return bits;
+}
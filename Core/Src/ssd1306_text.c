@@ -0,0 +1,276 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_text.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Text rendering into the SSD1306 framebuffer
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_text.h"
+
+
+/* Glyph offset and width of the proportional 5x7 font, blank columns trimmed */
+static const uint16_t font5x7p_offset[] = {
+      0,   7,  11,  15,  20,  25,  30,  36,  41,  46,  50,  55,  61,  65,  71,  75,
+     80,  86,  90,  95, 100, 105, 110, 115, 120, 125, 131, 136, 140, 145, 151, 155,
+    160, 165, 170, 175, 180, 185, 190, 195, 200, 206, 210, 215, 220, 225, 230, 235,
+    240, 245, 250, 255, 260, 265, 270, 275, 280, 285, 290, 296, 300, 306, 310, 315,
+    321, 325, 330, 335, 340, 345, 350, 355, 360, 366, 370, 375, 381, 385, 390, 395,
+    400, 405, 410, 415, 420, 425, 430, 435, 440, 445, 450, 456, 462, 466, 470, 475
+};
+
+static const uint8_t font5x7p_width[] = {
+    3, 1, 3, 5, 5, 5, 5, 2, 3, 3, 5, 5, 2, 5, 2, 5,
+    5, 3, 5, 5, 5, 5, 5, 5, 5, 5, 2, 2, 4, 5, 4, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 3, 5, 5,
+    3, 5, 5, 5, 5, 5, 5, 5, 5, 3, 4, 4, 3, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 1, 3, 5, 5
+};
+
+const SSD1306_Font_t ssd1306_font5x7 =
+{
+    .glyphs = (const uint8_t *)font,
+    .offset = 0,
+    .width = 0,
+    .pitch = 5,
+    .height = 8,
+    .first = 0x20,
+    .last = 0x7F,
+    .spacing = 1
+};
+
+const SSD1306_Font_t ssd1306_font5x7p =
+{
+    .glyphs = (const uint8_t *)font,
+    .offset = font5x7p_offset,
+    .width = font5x7p_width,
+    .pitch = 5,
+    .height = 8,
+    .first = 0x20,
+    .last = 0x7F,
+    .spacing = 1
+};
+
+/* Background column for the spacing after a glyph */
+static const uint8_t text_blank[SSD1306_FONT_MAX_HEIGHT / 8];
+
+
+
+static uint8_t ssd1306_text_glyph(const SSD1306_Font_t *text_font, char ch, const uint8_t **glyph);
+static uint8_t ssd1306_text_expand(const char *str, uint8_t *run, uint8_t max);
+
+
+
+/**
+ * @brief    Draw a string into the GDDRAM copy at any pixel position
+ *           Each glyph is followed by the font's spacing columns, which are
+ *           drawn as background with the same rop. Characters the font does not
+ *           have are drawn as its first character.
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @param    x_pos: x-coordinate of the text's upper left corner, can be negative
+ * @param    y_pos: y-coordinate of the text's upper left corner, can be negative
+ * @param    rop: how glyph pixels combine with the display, any one of SSD1306_Rop_t
+ * @retval   the on-screen area that was drawn, width 0 if fully clipped
+ */
+SSD1306_Rect_t ssd1306_drawText(const SSD1306_Font_t *text_font, const char *str,
+                                int16_t x_pos, int16_t y_pos, SSD1306_Rop_t rop)
+{
+    SSD1306_RenderMode_t mode = ssd1306_getRenderMode();
+    SSD1306_Rect_t area = { 0, 0, 0, 0 };
+    int16_t x = x_pos;
+
+    /* All glyphs reach the display in one flush */
+    ssd1306_setRenderMode(RENDER_DEFERRED);
+
+    for(; (*str != '\0') && (x < SSD1306_WIDTH); str++)
+    {
+        const uint8_t *glyph;
+        uint8_t width = ssd1306_text_glyph(text_font, *str, &glyph);
+
+        if( (x + width) > 0 )
+        {
+            ssd1306_blit(glyph, width, text_font->height, x, y_pos, rop);
+        }
+        x += width;
+
+        for(uint8_t i = 0; i < text_font->spacing; i++, x++)
+        {
+            if( (x >= 0) && (x < SSD1306_WIDTH) )
+            {
+                ssd1306_blit(text_blank, 1, text_font->height, x, y_pos, rop);
+            }
+        }
+    }
+
+    ssd1306_setRenderMode(mode);
+    if( mode == RENDER_IMMEDIATE )
+    {
+        ssd1306_flush();
+    }
+
+    /* Clip the drawn area to the display */
+    int16_t x_start = (x_pos < 0) ? 0 : x_pos;
+    int16_t x_end = (x > SSD1306_WIDTH) ? SSD1306_WIDTH : x;
+    int16_t y_start = (y_pos < 0) ? 0 : y_pos;
+    int16_t y_end = y_pos + text_font->height;
+
+    if( y_end > SSD1306_HEIGHT )
+    {
+        y_end = SSD1306_HEIGHT;
+    }
+
+    if( (x_start < x_end) && (y_start < y_end) )
+    {
+        area.x_pos = x_start;
+        area.y_pos = y_start;
+        area.width = x_end - x_start;
+        area.height = y_end - y_start;
+    }
+    return area;
+}
+
+
+/**
+ * @brief    Width of a string in pixels, spacing columns included
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    str: pointer to null-terminated string
+ * @retval   string width in pixels
+ */
+uint16_t ssd1306_textWidth(const SSD1306_Font_t *text_font, const char *str)
+{
+    uint16_t width = 0;
+
+    for(; *str != '\0'; str++)
+    {
+        const uint8_t *glyph;
+        width += ssd1306_text_glyph(text_font, *str, &glyph) + text_font->spacing;
+    }
+    return width;
+}
+
+
+
+/**
+ * @brief    Draw a string of the 5x7 font into one GDDRAM page
+ *           Fast path for page-aligned text: glyph columns are expanded into
+ *           a single run that is copied into the page with word copies. Text
+ *           past column 127 is dropped.
+ * @param    page: page to draw on, PAGE0..PAGE7
+ * @param    col: x-coordinate of the first column
+ * @param    str: pointer to null-terminated string
+ * @retval   number of columns drawn
+ */
+uint8_t ssd1306_drawTextLine(SSD1306_PageNum_t page, uint8_t col, const char *str)
+{
+    uint8_t run[SSD1306_WIDTH] __attribute__((aligned(4)));
+    uint8_t len = (col < SSD1306_WIDTH) ? ssd1306_text_expand(str, run, SSD1306_WIDTH - col) : 0;
+
+    if( len == 0 )
+    {
+        return 0;
+    }
+
+    ssd1306_ramWriteRun(page, col, run, len);
+    if( ssd1306_getRenderMode() == RENDER_IMMEDIATE )
+    {
+        ssd1306_flush();
+    }
+    return len;
+}
+
+
+/**
+ * @brief    Send a string of the 5x7 font straight to one display page
+ *           The expanded run goes out as a single windowed burst.
+ *           Note: The framebuffer is not updated.
+ * @param    page: page to draw on, PAGE0..PAGE7
+ * @param    col: x-coordinate of the first column
+ * @param    str: pointer to null-terminated string
+ * @retval   number of columns sent
+ */
+uint8_t ssd1306_sendTextLine(SSD1306_PageNum_t page, uint8_t col, const char *str)
+{
+    uint8_t run[SSD1306_WIDTH];
+    uint8_t len = (col < SSD1306_WIDTH) ? ssd1306_text_expand(str, run, SSD1306_WIDTH - col) : 0;
+
+    if( len )
+    {
+        ssd1306_displayWriteWindow(col, col + len - 1, page, page, run, len);
+    }
+    return len;
+}
+
+
+/**
+ * @brief    Look up the bitmap of a character
+ * @param    text_font: pointer to SSD1306_Font_t type structure
+ * @param    ch: character to look up
+ * @param    glyph: receives a pointer to the glyph's page-major bitmap
+ * @retval   glyph width in pixels
+ */
+static uint8_t ssd1306_text_glyph(const SSD1306_Font_t *text_font, char ch, const uint8_t **glyph)
+{
+    uint8_t index = 0;
+
+    if( ((uint8_t)ch >= text_font->first) && ((uint8_t)ch <= text_font->last) )
+    {
+        index = (uint8_t)ch - text_font->first;
+    }
+
+    if( text_font->width )
+    {
+        *glyph = text_font->glyphs + text_font->offset[index];
+        return text_font->width[index];
+    }
+
+    *glyph = text_font->glyphs + (index * text_font->pitch * ((text_font->height + 7) / 8));
+    return text_font->pitch;
+}
+
+
+/**
+ * @brief    Expand a string into 5x7 glyph columns, one blank column after
+ *           each glyph, the GDDRAM byte layout of a page
+ * @param    str: pointer to null-terminated string
+ * @param    run: receives the columns
+ * @param    max: size of run
+ * @retval   number of columns written to run
+ */
+static uint8_t ssd1306_text_expand(const char *str, uint8_t *run, uint8_t max)
+{
+    uint8_t len = 0;
+
+    for(; (*str != '\0') && (len < max); str++)
+    {
+        uint8_t ch = (uint8_t)*str;
+        const char *glyph = font[ ((ch >= 0x20) && (ch <= 0x7F)) ? (ch - 0x20) : 0 ];
+
+        for(uint8_t i = 0; (i < 5) && (len < max); i++)
+        {
+            run[len++] = glyph[i];
+        }
+        if( len < max )
+        {
+            run[len++] = 0x00;
+        }
+    }
+    return len;
+}
@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    ssd1306_tile.c
+  * @version v1.0
+  * @date    October 16, 2026
+  * @brief   Tile-map renderer for the SSD1306
+  ******************************************************************************
+  *
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * any later version.
+  * 
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  * 
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see https://www.gnu.org/licenses/gpl-3.0.en.html.
+  * 
+  ******************************************************************************
+**/
+
+#include "ssd1306_tile.h"
+
+
+/* Tile index of every cell and one changed bit per cell, 16 bits per row */
+static uint8_t tile_map[SSD1306_TILE_ROWS][SSD1306_TILE_COLS];
+static uint16_t tile_changed[SSD1306_TILE_ROWS];
+static const uint8_t (*tile_set)[8];
+
+
+
+/**
+ * @brief    Select the tile set and fill the map with tile 0
+ *           Every cell is marked changed so the next ssd1306_tileFlush()
+ *           redraws the whole screen.
+ * @param    tileset: pointer to array of 8 byte page-major tiles
+ * @retval   none
+ */
+void ssd1306_tileInit(const uint8_t (*tileset)[8])
+{
+    tile_set = tileset;
+
+    for(uint8_t row = 0; row < SSD1306_TILE_ROWS; row++)
+    {
+        for(uint8_t col = 0; col < SSD1306_TILE_COLS; col++)
+        {
+            tile_map[row][col] = 0;
+        }
+        tile_changed[row] = 0xFFFF;
+    }
+}
+
+
+/**
+ * @brief    Place a tile in a cell of the map, the cell is only marked
+ *           changed if its tile index differs
+ * @param    col: cell column, 0..15
+ * @param    row: cell row, PAGE0..PAGE7
+ * @param    tile: index into the tile set
+ * @retval   none
+ */
+void ssd1306_tileSet(uint8_t col, SSD1306_PageNum_t row, uint8_t tile)
+{
+    if( (col >= SSD1306_TILE_COLS) || (row >= SSD1306_TILE_ROWS) )
+    {
+        return;
+    }
+
+    if( tile_map[row][col] != tile )
+    {
+        tile_map[row][col] = tile;
+        tile_changed[row] |= (1U << col);
+    }
+}
+
+
+/**
+ * @brief    Read the tile index of a cell
+ * @param    col: cell column, 0..15, larger values read column 15
+ * @param    row: cell row, PAGE0..PAGE7, larger values read PAGE7
+ * @retval   index into the tile set
+ */
+uint8_t ssd1306_tileGet(uint8_t col, SSD1306_PageNum_t row)
+{
+    if( col >= SSD1306_TILE_COLS )
+    {
+        col = SSD1306_TILE_COLS - 1;
+    }
+    if( row >= SSD1306_TILE_ROWS )
+    {
+        row = SSD1306_TILE_ROWS - 1;
+    }
+
+    return tile_map[row][col];
+}
+
+
+/**
+ * @brief    Send the changed cells to the display
+ *           Neighbouring changed cells of a row are sent as one window.
+ *           Note: Tiles are written straight to the display, the framebuffer
+ *                 is not updated. Does nothing before ssd1306_tileInit().
+ * @param    none
+ * @retval   none
+ */
+void ssd1306_tileFlush(void)
+{
+    uint8_t run[SSD1306_WIDTH];
+
+    /* Nothing to draw with before ssd1306_tileInit() */
+    if( !tile_set )
+    {
+        return;
+    }
+
+    for(uint8_t row = 0; row < SSD1306_TILE_ROWS; row++)
+    {
+        uint16_t changed = tile_changed[row];
+        uint8_t col = 0;
+
+        while( changed >> col )
+        {
+            if( !(changed & (1U << col)) )
+            {
+                col++;
+                continue;
+            }
+
+            /* Collect the run of changed cells starting here */
+            uint8_t first = col;
+            uint8_t len = 0;
+
+            while( (col < SSD1306_TILE_COLS) && (changed & (1U << col)) )
+            {
+                const uint8_t *tile = tile_set[ tile_map[row][col] ];
+
+                for(uint8_t i = 0; i < 8; i++)
+                {
+                    run[len++] = tile[i];
+                }
+                col++;
+            }
+
+            ssd1306_displayWriteWindow(8 * first, (8 * col) - 1, row, row, run, len);
+        }
+        tile_changed[row] = 0;
+    }
+}
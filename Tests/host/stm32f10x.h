@@ -0,0 +1,171 @@
+/**
+  ******************************************************************************
+  * @file    stm32f10x.h
+  * @brief   Host stand-in for the STM32F10x device header
+  *
+  *          Found before CMSIS/device on the include path of the host tests.
+  *          The peripherals are plain structs in host memory holding only the
+  *          registers the drivers touch, bit definitions are the ones of the
+  *          device header. Interrupt masking and the NVIC are recorded so a
+  *          test can check them and call the IRQ handlers itself.
+  ******************************************************************************
+**/
+
+#ifndef __STM32F10x_H
+#define __STM32F10x_H
+
+#include <stdint.h>
+
+#define __IO    volatile
+
+
+/* Interrupt numbers used by the drivers */
+typedef enum
+{
+    DMA1_Channel4_IRQn          = 14,
+    DMA1_Channel6_IRQn          = 16,
+    I2C1_EV_IRQn                = 31,
+    I2C1_ER_IRQn                = 32,
+    I2C2_EV_IRQn                = 33,
+    I2C2_ER_IRQn                = 34
+} IRQn_Type;
+
+
+/* Register blocks */
+typedef struct
+{
+    __IO uint16_t CR1;
+    __IO uint16_t CR2;
+    __IO uint16_t OAR1;
+    __IO uint16_t OAR2;
+    __IO uint16_t DR;
+    __IO uint16_t SR1;
+    __IO uint16_t SR2;
+    __IO uint16_t CCR;
+    __IO uint16_t TRISE;
+} I2C_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CFGR;
+    __IO uint32_t AHBENR;
+    __IO uint32_t APB2ENR;
+    __IO uint32_t APB1ENR;
+} RCC_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CRL;
+    __IO uint32_t CRH;
+    __IO uint32_t BSRR;
+} GPIO_TypeDef;
+
+
+/* Peripheral instances, defined by the test */
+extern I2C_TypeDef host_i2c1, host_i2c2;
+extern DMA_TypeDef host_dma1;
+extern DMA_Channel_TypeDef host_dma1_channel4, host_dma1_channel6;
+extern RCC_TypeDef host_rcc;
+extern GPIO_TypeDef host_gpiob;
+extern uint32_t SystemCoreClock;
+
+#define I2C1                ( &host_i2c1 )
+#define I2C2                ( &host_i2c2 )
+#define DMA1                ( &host_dma1 )
+#define DMA1_Channel4       ( &host_dma1_channel4 )
+#define DMA1_Channel6       ( &host_dma1_channel6 )
+#define RCC                 ( &host_rcc )
+#define GPIOB               ( &host_gpiob )
+
+
+/* Interrupt masking and NVIC, recorded */
+extern uint32_t host_primask;
+extern uint32_t host_nvic_enabled;
+extern uint32_t host_nvic_pending;
+
+static inline uint32_t __get_PRIMASK(void) { return host_primask; }
+static inline void __set_PRIMASK(uint32_t primask) { host_primask = primask; }
+static inline void __disable_irq(void) { host_primask = 1; }
+static inline void __enable_irq(void) { host_primask = 0; }
+static inline void __DMB(void) { __sync_synchronize(); }
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq) { host_nvic_enabled |= ( 1UL << (irq - 14) ); }
+static inline void NVIC_SetPendingIRQ(IRQn_Type irq) { host_nvic_pending |= ( 1UL << (irq - 14) ); }
+
+
+/* Bit definitions, values of the device header */
+#define  DMA_CCR1_EN                         ((uint16_t)0x0001)
+#define  DMA_CCR1_TCIE                       ((uint16_t)0x0002)
+#define  DMA_CCR1_TEIE                       ((uint16_t)0x0008)
+#define  DMA_CCR1_DIR                        ((uint16_t)0x0010)
+#define  DMA_CCR1_MINC                       ((uint16_t)0x0080)
+#define  DMA_IFCR_CGIF1                      ((uint32_t)0x00000001)
+#define  DMA_IFCR_CGIF4                      ((uint32_t)0x00001000)
+#define  DMA_IFCR_CGIF6                      ((uint32_t)0x00100000)
+#define  DMA_ISR_TEIF4                       ((uint32_t)0x00008000)
+#define  DMA_ISR_TEIF6                       ((uint32_t)0x00800000)
+
+#define  GPIO_BSRR_BS6                       ((uint32_t)0x00000040)
+#define  GPIO_BSRR_BS7                       ((uint32_t)0x00000080)
+#define  GPIO_BSRR_BS8                       ((uint32_t)0x00000100)
+#define  GPIO_BSRR_BS9                       ((uint32_t)0x00000200)
+#define  GPIO_BSRR_BS10                      ((uint32_t)0x00000400)
+#define  GPIO_BSRR_BS11                      ((uint32_t)0x00000800)
+#define  GPIO_CRL_MODE6                      ((uint32_t)0x03000000)
+#define  GPIO_CRL_CNF6                       ((uint32_t)0x0C000000)
+#define  GPIO_CRL_MODE7                      ((uint32_t)0x30000000)
+#define  GPIO_CRL_CNF7                       ((uint32_t)0xC0000000)
+#define  GPIO_CRH_MODE8                      ((uint32_t)0x00000003)
+#define  GPIO_CRH_CNF8                       ((uint32_t)0x0000000C)
+#define  GPIO_CRH_MODE9                      ((uint32_t)0x00000030)
+#define  GPIO_CRH_CNF9                       ((uint32_t)0x000000C0)
+#define  GPIO_CRH_MODE10                     ((uint32_t)0x00000300)
+#define  GPIO_CRH_CNF10                      ((uint32_t)0x00000C00)
+#define  GPIO_CRH_MODE11                     ((uint32_t)0x00003000)
+#define  GPIO_CRH_CNF11                      ((uint32_t)0x0000C000)
+
+#define  I2C_CR1_PE                          ((uint16_t)0x0001)
+#define  I2C_CR1_START                       ((uint16_t)0x0100)
+#define  I2C_CR1_STOP                        ((uint16_t)0x0200)
+#define  I2C_CR1_ACK                         ((uint16_t)0x0400)
+#define  I2C_CR1_POS                         ((uint16_t)0x0800)
+#define  I2C_CR1_SWRST                       ((uint16_t)0x8000)
+#define  I2C_CR2_ITERREN                     ((uint16_t)0x0100)
+#define  I2C_CR2_ITEVTEN                     ((uint16_t)0x0200)
+#define  I2C_CR2_ITBUFEN                     ((uint16_t)0x0400)
+#define  I2C_CR2_DMAEN                       ((uint16_t)0x0800)
+#define  I2C_SR1_SB                          ((uint16_t)0x0001)
+#define  I2C_SR1_ADDR                        ((uint16_t)0x0002)
+#define  I2C_SR1_BTF                         ((uint16_t)0x0004)
+#define  I2C_SR1_STOPF                       ((uint16_t)0x0010)
+#define  I2C_SR1_RXNE                        ((uint16_t)0x0040)
+#define  I2C_SR1_TXE                         ((uint16_t)0x0080)
+#define  I2C_SR1_BERR                        ((uint16_t)0x0100)
+#define  I2C_SR1_ARLO                        ((uint16_t)0x0200)
+#define  I2C_SR1_AF                          ((uint16_t)0x0400)
+#define  I2C_SR1_OVR                         ((uint16_t)0x0800)
+#define  I2C_SR1_TIMEOUT                     ((uint16_t)0x4000)
+#define  I2C_CCR_DUTY                        ((uint16_t)0x4000)
+#define  I2C_CCR_FS                          ((uint16_t)0x8000)
+
+#define  RCC_AHBENR_DMA1EN                   ((uint16_t)0x0001)
+#define  RCC_APB2ENR_AFIOEN                  ((uint32_t)0x00000001)
+#define  RCC_APB2ENR_IOPBEN                  ((uint32_t)0x00000008)
+#define  RCC_APB1ENR_I2C1EN                  ((uint32_t)0x00200000)
+#define  RCC_APB1ENR_I2C2EN                  ((uint32_t)0x00400000)
+
+#endif
@@ -0,0 +1,281 @@
+/**
+  ******************************************************************************
+  * @file    test_i2c_dma.c
+  * @brief   Host test of the DMA completion and error paths of
+  *          i2c_write_dma() and of the transaction queue
+  *
+  *          Drives Core/Src/i2c.c through the register stand-in: the test
+  *          sets the status flags the hardware would raise and calls the
+  *          interrupt handlers in the order the hardware would.
+  ******************************************************************************
+**/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "stm32f10x.h"
+#include "i2c.h"
+
+
+I2C_TypeDef host_i2c1, host_i2c2;
+DMA_TypeDef host_dma1;
+DMA_Channel_TypeDef host_dma1_channel4, host_dma1_channel6;
+RCC_TypeDef host_rcc;
+GPIO_TypeDef host_gpiob;
+uint32_t SystemCoreClock = 72000000UL;
+
+uint32_t host_primask;
+uint32_t host_nvic_enabled;
+uint32_t host_nvic_pending;
+
+void I2C1_EV_IRQHandler(void);
+void I2C1_ER_IRQHandler(void);
+void DMA1_Channel6_IRQHandler(void);
+
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if( !(cond) )                                                       \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while(0)
+
+
+#define IRQ_BIT(irq)        ( 1UL << ((irq) - 14) )
+#define I2C_IT_ALL          ( I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN )
+
+static uint8_t frame[64];
+static uint32_t callbacks;
+static uint8_t callback_error;
+
+
+void delay_us(uint32_t us)
+{
+    (void)us;
+}
+
+
+static void on_done(void)
+{
+    callbacks++;
+    callback_error = i2c_txError(I2C1);
+}
+
+
+/* Claim the bus, address the slave and hand the frame to DMA */
+static void begin_dma_write(void)
+{
+    callbacks = 0;
+    callback_error = 0xFF;
+
+    CHECK( i2c_claim(I2C1) );
+
+    /* EV5 and EV6 are polled, both flags are already up */
+    host_i2c1.SR1 = ( I2C_SR1_SB | I2C_SR1_ADDR );
+    i2c_start(I2C1);
+    CHECK( host_i2c1.CR1 & I2C_CR1_START );
+    i2c_request(I2C1, 0x78);
+    CHECK( host_i2c1.DR == 0x78 );
+
+    host_i2c1.CR1 = I2C_CR1_PE;
+    host_i2c1.SR1 = 0;
+
+    i2c_write_dma(I2C1, sizeof(frame), frame, on_done);
+}
+
+
+static void test_init(void)
+{
+    I2C_Init_t conf;
+
+    i2c_structInit(&conf);
+    conf.I2C_DMA_TRANSFER = I2C_DMA_ENABLE;
+    i2c_init(I2C1, &conf);
+
+    CHECK( host_rcc.AHBENR & RCC_AHBENR_DMA1EN );
+    CHECK( host_nvic_enabled & IRQ_BIT(DMA1_Channel6_IRQn) );
+    CHECK( host_nvic_enabled & IRQ_BIT(I2C1_EV_IRQn) );
+    CHECK( host_nvic_enabled & IRQ_BIT(I2C1_ER_IRQn) );
+    CHECK( host_i2c1.CR1 & I2C_CR1_PE );
+    CHECK( !i2c_busy(I2C1) );
+}
+
+
+/* EV6 -> DMA -> BTF -> STOP */
+static void test_dma_complete(void)
+{
+    uint32_t errors = i2c_queueErrors(I2C1);
+
+    begin_dma_write();
+
+    /* Channel armed memory to peripheral, completion is left to BTF */
+    CHECK( host_dma1_channel6.CPAR == (uint32_t)(uintptr_t)&host_i2c1.DR );
+    CHECK( host_dma1_channel6.CMAR == (uint32_t)(uintptr_t)frame );
+    CHECK( host_dma1_channel6.CNDTR == sizeof(frame) );
+    CHECK( host_dma1_channel6.CCR == ( DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_TEIE | DMA_CCR1_EN ) );
+    CHECK( host_i2c1.CR2 & I2C_CR2_DMAEN );
+    CHECK( (host_i2c1.CR2 & ( I2C_CR2_ITEVTEN | I2C_CR2_ITERREN )) == ( I2C_CR2_ITEVTEN | I2C_CR2_ITERREN ) );
+    CHECK( i2c_busy(I2C1) );
+    CHECK( callbacks == 0 );
+
+    /* BTF while DMA still has bytes to move, nothing ends yet */
+    host_dma1_channel6.CNDTR = 10;
+    host_i2c1.SR1 = ( I2C_SR1_TXE | I2C_SR1_BTF );
+    I2C1_EV_IRQHandler();
+    CHECK( !(host_i2c1.CR1 & I2C_CR1_STOP) );
+    CHECK( callbacks == 0 );
+    CHECK( i2c_busy(I2C1) );
+
+    /* EV8_2 - last byte shifted out */
+    host_dma1_channel6.CNDTR = 0;
+    I2C1_EV_IRQHandler();
+    CHECK( host_i2c1.CR1 & I2C_CR1_STOP );
+    CHECK( callbacks == 1 );
+    CHECK( callback_error == 0 );
+    CHECK( !i2c_txError(I2C1) );
+    CHECK( !i2c_busy(I2C1) );
+    CHECK( !(host_dma1_channel6.CCR & DMA_CCR1_EN) );
+    CHECK( !(host_i2c1.CR2 & ( I2C_CR2_DMAEN | I2C_IT_ALL )) );
+    CHECK( i2c_queueErrors(I2C1) == errors );
+}
+
+
+/* TEIE -> channel interrupt -> STOP, reported through i2c_txError() */
+static void test_dma_transfer_error(void)
+{
+    uint32_t errors = i2c_queueErrors(I2C1);
+
+    begin_dma_write();
+
+    host_dma1.ISR = DMA_ISR_TEIF6;
+    host_dma1.IFCR = 0;
+    DMA1_Channel6_IRQHandler();
+
+    CHECK( host_dma1.IFCR == DMA_IFCR_CGIF6 );
+    CHECK( host_i2c1.CR1 & I2C_CR1_STOP );
+    CHECK( callbacks == 1 );
+    CHECK( callback_error == 1 );
+    CHECK( i2c_txError(I2C1) );
+    CHECK( i2c_queueErrors(I2C1) == errors + 1 );
+    CHECK( !i2c_busy(I2C1) );
+    CHECK( !(host_dma1_channel6.CCR & DMA_CCR1_EN) );
+    CHECK( !(host_i2c1.CR2 & ( I2C_CR2_DMAEN | I2C_IT_ALL )) );
+}
+
+
+/* NACK during the DMA write -> error interrupt -> STOP */
+static void test_dma_nack(void)
+{
+    uint32_t errors = i2c_queueErrors(I2C1);
+
+    begin_dma_write();
+
+    host_i2c1.SR1 = I2C_SR1_AF;
+    I2C1_ER_IRQHandler();
+
+    /* SR1 is rc_w0: one write of 0 to AF and 1 everywhere else */
+    CHECK( host_i2c1.SR1 == (uint16_t)~I2C_SR1_AF );
+    CHECK( host_i2c1.CR1 & I2C_CR1_STOP );
+    CHECK( callbacks == 1 );
+    CHECK( callback_error == 1 );
+    CHECK( i2c_queueErrors(I2C1) == errors + 1 );
+    CHECK( !i2c_busy(I2C1) );
+    CHECK( !(host_dma1_channel6.CCR & DMA_CCR1_EN) );
+}
+
+
+/* Queued DMA payload behind a pending stop condition: the start is issued by
+   polling, never by re-entering the event interrupt */
+static void test_queue_stop_pending(void)
+{
+    uint32_t errors = i2c_queueErrors(I2C1);
+
+    callbacks = 0;
+    callback_error = 0xFF;
+    host_nvic_pending = 0;
+
+    host_i2c1.CR1 = ( I2C_CR1_PE | I2C_CR1_STOP );
+    host_i2c1.SR1 = 0;
+    CHECK( i2c_enqueue(I2C1, 0x78, 0x40, sizeof(frame), frame, on_done) );
+    CHECK( i2c_busy(I2C1) );
+    CHECK( !(host_i2c1.CR1 & I2C_CR1_START) );
+    CHECK( !(host_i2c1.CR2 & I2C_IT_ALL) );
+    CHECK( !i2c_claim(I2C1) );
+
+    /* Stop condition sent, the next poll starts the transaction */
+    host_i2c1.CR1 = I2C_CR1_PE;
+    CHECK( i2c_busy(I2C1) );
+    CHECK( host_i2c1.CR1 & I2C_CR1_START );
+    CHECK( (host_i2c1.CR2 & I2C_IT_ALL) == I2C_IT_ALL );
+    host_i2c1.CR1 = I2C_CR1_PE;
+
+    /* EV5 */
+    host_i2c1.SR1 = I2C_SR1_SB;
+    I2C1_EV_IRQHandler();
+    CHECK( host_i2c1.DR == 0x78 );
+
+    /* EV6 - control byte, then the payload is handed to DMA */
+    host_i2c1.SR1 = I2C_SR1_ADDR;
+    I2C1_EV_IRQHandler();
+    CHECK( host_i2c1.DR == 0x40 );
+    CHECK( host_dma1_channel6.CMAR == (uint32_t)(uintptr_t)frame );
+    CHECK( host_dma1_channel6.CNDTR == sizeof(frame) );
+    CHECK( host_dma1_channel6.CCR & DMA_CCR1_EN );
+    CHECK( host_i2c1.CR2 & I2C_CR2_DMAEN );
+    CHECK( !(host_i2c1.CR2 & I2C_CR2_ITBUFEN) );
+
+    /* EV8_2 */
+    host_dma1_channel6.CNDTR = 0;
+    host_i2c1.SR1 = ( I2C_SR1_TXE | I2C_SR1_BTF );
+    I2C1_EV_IRQHandler();
+    CHECK( host_i2c1.CR1 & I2C_CR1_STOP );
+    CHECK( callbacks == 1 );
+    CHECK( callback_error == 0 );
+    CHECK( !i2c_busy(I2C1) );
+
+    /* Stop condition that never goes out, aborted after I2C_STOP_RETRIES polls */
+    callbacks = 0;
+    host_i2c1.CR1 = ( I2C_CR1_PE | I2C_CR1_STOP );
+    CHECK( i2c_enqueue(I2C1, 0x78, 0x40, sizeof(frame), frame, on_done) );
+    for(uint32_t i = 0; i < I2C_STOP_RETRIES; i++)
+    {
+        CHECK( i2c_busy(I2C1) );
+    }
+    CHECK( callbacks == 0 );
+    CHECK( !i2c_busy(I2C1) );
+    CHECK( callbacks == 1 );
+    CHECK( callback_error == 1 );
+    CHECK( i2c_queueErrors(I2C1) == errors + 1 );
+    CHECK( !(host_i2c1.CR1 & I2C_CR1_START) );
+
+    CHECK( host_nvic_pending == 0 );
+}
+
+
+int main(void)
+{
+    memset(frame, 0xA5, sizeof(frame));
+
+    test_init();
+    test_dma_complete();
+    test_dma_transfer_error();
+    test_dma_nack();
+    test_queue_stop_pending();
+
+    /* A good transfer after the failed ones clears the error */
+    test_dma_complete();
+
+    if( failures )
+    {
+        printf("test_i2c_dma: %d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("test_i2c_dma: ok\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# fontgen.py - build-time generator of scaled SSD1306 fonts
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+#
+# Reads the 5x7 font[][5] table of ssd1306_font.h and writes a C source and
+# header holding one SSD1306_Font_t per requested scale and character range.
+# Glyphs are pre-scaled and page-major, ready for ssd1306_drawText().
+#
+# usage: fontgen.py -o <output basename> <font header> name:scale:first:last ...
+#        first and last are hex character codes, e.g. digits at 4x:
+#        ssd1306_font5x7_4x_digits:4:30:39
+#
+
+import re
+import sys
+
+FONT_FIRST = 0x20
+FONT_PITCH = 5
+MAX_HEIGHT = 32
+
+
+def read_font(path):
+    text = open(path).read()
+    start = text.index("font[][5]")
+    table = text[start:text.index("};", start)]
+    glyphs = []
+    for row in re.findall(r"\{([^}]*)\}", table):
+        glyphs.append([int(b, 16) for b in re.findall(r"0x([0-9a-fA-F]{2})", row)])
+    return glyphs
+
+
+def scale_glyph(glyph, scale):
+    """Page-major bytes of a glyph scaled by an integer factor"""
+    pages = scale
+    width = FONT_PITCH * scale
+    out = []
+    for page in range(pages):
+        for col in range(width):
+            src = glyph[col // scale]
+            byte = 0
+            for bit in range(8):
+                row = (8 * page + bit) // scale
+                if src & (1 << row):
+                    byte |= 1 << bit
+            out.append(byte)
+    return out
+
+
+def parse_spec(spec):
+    name, scale, first, last = spec.split(":")
+    scale, first, last = int(scale), int(first, 16), int(last, 16)
+    if not re.match(r"^[A-Za-z_]\w*$", name):
+        sys.exit("fontgen: bad font name '%s'" % name)
+    if scale < 1 or 8 * scale > MAX_HEIGHT:
+        sys.exit("fontgen: %s: scale must be 1..%d" % (name, MAX_HEIGHT // 8))
+    if first > last:
+        sys.exit("fontgen: %s: empty character range" % name)
+    return name, scale, first, last
+
+
+def main(argv):
+    if len(argv) < 4 or argv[1] != "-o":
+        sys.exit("usage: fontgen.py -o <output basename> <font header> name:scale:first:last ...")
+
+    base = argv[2]
+    glyphs = read_font(argv[3])
+    fonts = [parse_spec(spec) for spec in argv[4:]]
+    guard = "__" + re.sub(r"\W", "_", base.split("/")[-1]).upper() + "_H"
+
+    src = ["/* Generated by Tools/fontgen.py, do not edit */", "",
+           '#include "%s.h"' % base.split("/")[-1], ""]
+    hdr = ["/* Generated by Tools/fontgen.py, do not edit */", "",
+           "#ifndef %s" % guard, "#define %s" % guard, "",
+           '#include "ssd1306_text.h"', ""]
+
+    for name, scale, first, last in fonts:
+        last = min(last, FONT_FIRST + len(glyphs) - 1)
+        data = []
+        for ch in range(first, last + 1):
+            index = ch - FONT_FIRST if ch >= FONT_FIRST else 0
+            data += scale_glyph(glyphs[index], scale)
+
+        src.append("static const uint8_t %s_glyphs[] = {" % name)
+        for i in range(0, len(data), 16):
+            src.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+        src += ["};", "",
+                "const SSD1306_Font_t %s =" % name, "{",
+                "    .glyphs = %s_glyphs," % name,
+                "    .offset = 0,",
+                "    .width = 0,",
+                "    .pitch = %d," % (FONT_PITCH * scale),
+                "    .height = %d," % (8 * scale),
+                "    .first = 0x%02X," % first,
+                "    .last = 0x%02X," % last,
+                "    .spacing = %d" % scale,
+                "};", ""]
+        decl = "extern const SSD1306_Font_t %s;" % name
+        hdr.append("%s /* %dx, 0x%02X..0x%02X */" % (decl.ljust(60), scale, first, last))
+
+    hdr += ["", "#endif /* %s */" % guard, ""]
+
+    open(base + ".c", "w").write("\n".join(src))
+    open(base + ".h", "w").write("\n".join(hdr))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
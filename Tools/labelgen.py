@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# labelgen.py - build-time generator of pre-rendered SSD1306 labels
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+#
+# Renders the strings listed in a label definition file with the 5x7 font of
+# ssd1306_font.h and writes them as page-major SSD1306_Bitmap_t constants,
+# ready for ssd1306_blit() or, when 8 pixels high, a straight GDDRAM burst.
+# Each definition line reads:
+#
+#     SSD1306_LABEL(name, scale, "text")
+#
+# usage: labelgen.py -o <output basename> <font header> <label definitions>
+#
+
+import re
+import sys
+
+sys.dont_write_bytecode = True
+from fontgen import FONT_FIRST, FONT_PITCH, read_font, scale_glyph
+
+LABEL = re.compile(r'^\s*SSD1306_LABEL\(\s*([A-Za-z_]\w*)\s*,\s*([1-4])\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+
+
+def render(glyphs, text, scale):
+    """Page-major bytes of a string, one blank column per glyph after it"""
+    pages = scale
+    columns = [[] for _ in range(pages)]
+    for ch in text:
+        index = ord(ch) - FONT_FIRST
+        if index < 0 or index >= len(glyphs):
+            index = 0
+        glyph = scale_glyph(glyphs[index], scale)
+        width = FONT_PITCH * scale
+        for page in range(pages):
+            columns[page] += glyph[width * page:width * (page + 1)] + [0] * scale
+    return len(columns[0]), 8 * scale, sum(columns, [])
+
+
+def main(argv):
+    if len(argv) != 5 or argv[1] != "-o":
+        sys.exit("usage: labelgen.py -o <output basename> <font header> <label definitions>")
+
+    base = argv[2]
+    glyphs = read_font(argv[3])
+    guard = "__" + re.sub(r"\W", "_", base.split("/")[-1]).upper() + "_H"
+
+    src = ["/* Generated by Tools/labelgen.py, do not edit */", "",
+           '#include "%s.h"' % base.split("/")[-1], ""]
+    hdr = ["/* Generated by Tools/labelgen.py, do not edit */", "",
+           "#ifndef %s" % guard, "#define %s" % guard, "",
+           '#include "ssd1306_text.h"', ""]
+
+    for number, line in enumerate(open(argv[4]), 1):
+        match = LABEL.match(line)
+        if not match:
+            if line.strip() and not line.strip().startswith(("/*", "*", "//")):
+                sys.exit("%s:%d: not a label definition" % (argv[4], number))
+            continue
+
+        name, scale = match.group(1), int(match.group(2))
+        text = match.group(3).encode().decode("unicode_escape")
+        width, height, data = render(glyphs, text, scale)
+        if width > 128:
+            sys.exit("%s:%d: label '%s' is %d pixels wide" % (argv[4], number, name, width))
+
+        src.append("static const uint8_t ssd1306_label_%s_bitmap[] = {" % name)
+        for i in range(0, len(data), 16):
+            src.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+        src += ["};", "",
+                "const SSD1306_Bitmap_t ssd1306_label_%s =" % name, "{",
+                "    .bitmap = ssd1306_label_%s_bitmap," % name,
+                "    .width = %d," % width,
+                "    .height = %d" % height,
+                "};", ""]
+        decl = "extern const SSD1306_Bitmap_t ssd1306_label_%s;" % name
+        hdr.append("%s /* \"%s\", %dx */" % (decl.ljust(60), match.group(3).replace("*/", "*\\/"), scale))
+
+    hdr += ["", "#endif /* %s */" % guard, ""]
+
+    open(base + ".c", "w").write("\n".join(src))
+    open(base + ".h", "w").write("\n".join(hdr))
+
+
+if __name__ == "__main__":
+    main(sys.argv)